@@ -0,0 +1,80 @@
+#ifndef __JSON_ALLOCATION_COUNTER_HPP
+#define __JSON_ALLOCATION_COUNTER_HPP
+
+// Replaces the global allocation functions, so this must be included by exactly one
+// translation unit of a test or benchmark executable, never by library code.
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace json
+{
+
+struct allocation_stats
+{
+	std::size_t count;
+	std::size_t bytes;
+};
+
+namespace
+{
+thread_local int active_guards{};
+thread_local allocation_stats allocations{};
+
+void* counted_allocate(std::size_t size, std::size_t alignment = 0)
+{
+	if (size == 0)
+		size = 1;
+
+	if (active_guards != 0)
+	{
+		allocations.count++;
+		allocations.bytes += size;
+	}
+
+	void* ptr = alignment != 0
+		? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+		: std::malloc(size);
+
+	if (ptr == nullptr)
+		throw std::bad_alloc{};
+
+	return ptr;
+}
+}
+
+// counts the allocations made on the current thread for as long as it is alive
+class allocation_guard
+{
+public:
+	allocation_guard() : start{ allocations } { active_guards++; }
+	~allocation_guard() { active_guards--; }
+
+	allocation_guard(const allocation_guard&) = delete;
+	allocation_guard& operator=(const allocation_guard&) = delete;
+
+	std::size_t count() const { return allocations.count - start.count; }
+	std::size_t bytes() const { return allocations.bytes - start.bytes; }
+
+private:
+	allocation_stats start;
+};
+
+} // json
+
+void* operator new(std::size_t size) { return json::counted_allocate(size); }
+void* operator new[](std::size_t size) { return json::counted_allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return json::counted_allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return json::counted_allocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+#endif // __JSON_ALLOCATION_COUNTER_HPP
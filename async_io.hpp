@@ -0,0 +1,189 @@
+#ifndef __JSON_ASYNC_IO_HPP
+#define __JSON_ASYNC_IO_HPP
+
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define JSON_HAS_POSIX_IO
+#endif
+
+#ifdef JSON_HAS_POSIX_IO
+
+#include <sys/uio.h>
+
+#if __has_include(<linux/io_uring.h>) && __has_include(<sys/syscall.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define JSON_HAS_IO_URING
+#endif
+#endif
+
+namespace json
+{
+
+inline int write_all(const int fd, const char* data, std::size_t size)
+{
+	while (size != 0)
+	{
+		if (const ssize_t n = ::write(fd, data, size); n >= 0)
+		{
+			data += n;
+			size -= n;
+		}
+		else if (errno != EINTR)
+		{
+			return errno;
+		}
+	}
+
+	return 0;
+}
+
+#ifdef JSON_HAS_IO_URING
+// A minimal io_uring for one operation in flight at a time, talking to the kernel directly so
+// there's no dependency on liburing.
+class io_uring_ring
+{
+public:
+	io_uring_ring()
+	{
+		io_uring_params params{};
+
+		ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, 2, &params));
+		if (ring_fd < 0)
+			return;
+
+		sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			sq_size = cq_size = std::max(sq_size, cq_size);
+
+		sq_ring = map(sq_size, IORING_OFF_SQ_RING);
+		cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) ? sq_ring : map(cq_size, IORING_OFF_CQ_RING);
+		sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+
+		if (sq_ring == nullptr || cq_ring == nullptr || sqes == nullptr)
+		{
+			release();
+			return;
+		}
+
+		sq_tail = ring_field(sq_ring, params.sq_off.tail);
+		sq_mask = *ring_field(sq_ring, params.sq_off.ring_mask);
+		sq_array = ring_field(sq_ring, params.sq_off.array);
+		cq_head = ring_field(cq_ring, params.cq_off.head);
+		cq_tail = ring_field(cq_ring, params.cq_off.tail);
+		cq_mask = *ring_field(cq_ring, params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(cq_ring) + params.cq_off.cqes);
+	}
+
+	io_uring_ring(const io_uring_ring&) = delete;
+	io_uring_ring& operator=(const io_uring_ring&) = delete;
+
+	~io_uring_ring() { release(); }
+
+	// false if the kernel doesn't support io_uring, or it isn't permitted
+	bool valid() const { return ring_fd >= 0; }
+
+	// queues a single IORING_OP_READV or IORING_OP_WRITEV of iov and submits it, returns errno on failure
+	int submit(const std::uint8_t opcode, const int fd, const iovec* const iov, const std::uint64_t offset)
+	{
+		const unsigned tail = *sq_tail;
+		const unsigned index = tail & sq_mask;
+
+		io_uring_sqe& sqe = sqes[index];
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = opcode;
+		sqe.fd = fd;
+		sqe.addr = reinterpret_cast<std::uint64_t>(iov);
+		sqe.len = 1;
+		sqe.off = offset;
+
+		sq_array[index] = index;
+		std::atomic_ref<unsigned>{ *sq_tail }.store(tail + 1, std::memory_order_release);
+
+		for (;;)
+		{
+			if (::syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0) >= 0)
+				return 0;
+
+			if (errno != EINTR)
+				return errno;
+		}
+	}
+
+	// waits for the next completion, returns its result: a byte count or -errno
+	int reap()
+	{
+		for (;;)
+		{
+			const unsigned head = std::atomic_ref<unsigned>{ *cq_head }.load(std::memory_order_relaxed);
+
+			if (head != std::atomic_ref<unsigned>{ *cq_tail }.load(std::memory_order_acquire))
+			{
+				const int result = cqes[head & cq_mask].res;
+				std::atomic_ref<unsigned>{ *cq_head }.store(head + 1, std::memory_order_release);
+				return result;
+			}
+
+			if (::syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+				return -errno;
+		}
+	}
+
+private:
+	int ring_fd{ -1 };
+	void* sq_ring{};
+	void* cq_ring{};
+	io_uring_sqe* sqes{};
+	io_uring_cqe* cqes{};
+	std::size_t sq_size{}, cq_size{}, sqes_size{};
+	unsigned* sq_tail{};
+	unsigned* sq_array{};
+	unsigned* cq_head{};
+	unsigned* cq_tail{};
+	unsigned sq_mask{}, cq_mask{};
+
+	void* map(const std::size_t size, const off_t region)
+	{
+		void* const ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, region);
+		return ptr == MAP_FAILED ? nullptr : ptr;
+	}
+
+	static unsigned* ring_field(void* const ring, const unsigned offset)
+	{
+		return reinterpret_cast<unsigned*>(static_cast<char*>(ring) + offset);
+	}
+
+	void release()
+	{
+		if (sqes != nullptr)
+			::munmap(sqes, sqes_size);
+		if (cq_ring != nullptr && cq_ring != sq_ring)
+			::munmap(cq_ring, cq_size);
+		if (sq_ring != nullptr)
+			::munmap(sq_ring, sq_size);
+		if (ring_fd >= 0)
+			::close(ring_fd);
+
+		ring_fd = -1;
+		sq_ring = cq_ring = nullptr;
+		sqes = nullptr;
+	}
+};
+#endif // JSON_HAS_IO_URING
+
+} // json
+
+#endif // JSON_HAS_POSIX_IO
+
+#endif // __JSON_ASYNC_IO_HPP
@@ -0,0 +1,275 @@
+#ifndef __JSON_ASYNC_SINK_HPP
+#define __JSON_ASYNC_SINK_HPP
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "sink.hpp"
+#include "async_io.hpp"
+
+#ifdef JSON_HAS_POSIX_IO
+
+namespace json
+{
+
+// Writes one buffer to a file descriptor in the background at a time.
+class async_writer
+{
+public:
+	virtual ~async_writer() = default;
+
+	// starts writing all of [data, data + size), the buffer must stay untouched until wait returns
+	virtual void submit(const char* data, std::size_t size) = 0;
+
+	// blocks until the last submitted buffer is written, returns errno of a failed write or 0
+	virtual int wait() = 0;
+};
+
+class thread_writer : public async_writer
+{
+public:
+	explicit thread_writer(const int fd) : fd{ fd }, worker{ [this]() { run(); } } {}
+
+	~thread_writer() override
+	{
+		{
+			std::lock_guard lock{ mutex };
+			stopping = true;
+		}
+
+		cv.notify_all();
+		worker.join();
+	}
+
+	void submit(const char* const data, const std::size_t size) override
+	{
+		{
+			std::lock_guard lock{ mutex };
+			pending_data = data;
+			pending_size = size;
+			pending = true;
+		}
+
+		cv.notify_all();
+	}
+
+	int wait() override
+	{
+		std::unique_lock lock{ mutex };
+		cv.wait(lock, [this]() { return !pending; });
+		return error;
+	}
+
+private:
+	int fd;
+	std::mutex mutex;
+	std::condition_variable cv;
+	const char* pending_data{};
+	std::size_t pending_size{};
+	bool pending{};
+	bool stopping{};
+	int error{};
+	std::thread worker;
+
+	void run()
+	{
+		std::unique_lock lock{ mutex };
+
+		for (;;)
+		{
+			cv.wait(lock, [this]() { return pending || stopping; });
+
+			if (!pending)
+				return;
+
+			lock.unlock();
+			const int result = write_all(fd, pending_data, pending_size);
+			lock.lock();
+
+			if (error == 0)
+				error = result;
+
+			pending = false;
+			cv.notify_all();
+		}
+	}
+};
+
+#ifdef JSON_HAS_IO_URING
+// Writes go to explicit offsets when the file is seekable, and the file position is moved past
+// them once done, as if they'd been written synchronously.
+class io_uring_writer : public async_writer
+{
+public:
+	explicit io_uring_writer(const int fd) : fd{ fd }
+	{
+		if (const off_t position = ::lseek(fd, 0, SEEK_CUR); position >= 0)
+		{
+			offset = position;
+			seekable = true;
+		}
+	}
+
+	~io_uring_writer() override { wait(); }
+
+	bool valid() const { return ring.valid(); }
+
+	void submit(const char* const data, const std::size_t size) override
+	{
+		remaining_data = data;
+		remaining_size = size;
+		enqueue();
+	}
+
+	int wait() override
+	{
+		while (in_flight)
+		{
+			const int result = ring.reap();
+			in_flight = false;
+
+			if (result < 0)
+			{
+				if (result == -EINTR || result == -EAGAIN)
+				{
+					enqueue();
+					continue;
+				}
+
+				if (error == 0)
+					error = -result;
+
+				continue;
+			}
+
+			remaining_data += result;
+			remaining_size -= result;
+
+			if (seekable)
+				offset += result;
+
+			if (result == 0 && remaining_size != 0 && error == 0)
+				error = EIO;
+			else if (remaining_size != 0)
+				enqueue();
+		}
+
+		if (seekable && error == 0)
+			::lseek(fd, offset, SEEK_SET);
+
+		return error;
+	}
+
+private:
+	int fd;
+	io_uring_ring ring;
+	iovec iov{};
+	const char* remaining_data{};
+	std::size_t remaining_size{};
+	off_t offset{};
+	bool seekable{};
+	bool in_flight{};
+	int error{};
+
+	void enqueue()
+	{
+		iov = iovec{ const_cast<char*>(remaining_data), remaining_size };
+
+		if (const int result = ring.submit(IORING_OP_WRITEV, fd, &iov, seekable ? offset : 0); result != 0)
+		{
+			if (error == 0)
+				error = result;
+
+			return;
+		}
+
+		in_flight = true;
+	}
+};
+#endif // JSON_HAS_IO_URING
+
+// Double buffered sink: while one buffer is being written to the file descriptor in the
+// background, the stringifier fills the other, so formatting overlaps with I/O. Uses io_uring
+// where the kernel supports it, and a writer thread otherwise.
+class async_fd_sink : public sink
+{
+public:
+	static constexpr std::size_t default_buffer_size = 1 << 20;
+
+	explicit async_fd_sink(const int fd, const std::size_t buffer_size = default_buffer_size, const bool allow_io_uring = true)
+		: size{ buffer_size }, buffers{ std::make_unique<char[]>(buffer_size), std::make_unique<char[]>(buffer_size) }
+	{
+#ifdef JSON_HAS_IO_URING
+		if (allow_io_uring)
+		{
+			if (auto uring = std::make_unique<io_uring_writer>(fd); uring->valid())
+			{
+				writer = std::move(uring);
+				using_io_uring = true;
+			}
+		}
+#endif
+
+		if (!writer)
+			writer = std::make_unique<thread_writer>(fd);
+
+		set_buffer(buffers[0].get(), size);
+	}
+
+	~async_fd_sink() override { finish(); }
+
+	// flushes and waits for everything to be written
+	void finish()
+	{
+		flush();
+		wait();
+	}
+
+	bool good() const { return error == 0; }
+
+	bool uses_io_uring() const { return using_io_uring; }
+
+	int error{}; // errno of the first failed write
+
+protected:
+	void flush_buffer() override
+	{
+		wait();
+
+		if (error == 0)
+		{
+			writer->submit(first, pos - first);
+			writing = true;
+		}
+
+		current = 1 - current;
+		set_buffer(buffers[current].get(), size);
+	}
+
+private:
+	std::size_t size;
+	std::unique_ptr<char[]> buffers[2];
+	std::unique_ptr<async_writer> writer;
+	int current{};
+	bool writing{};
+	bool using_io_uring{};
+
+	void wait()
+	{
+		if (!writing)
+			return;
+
+		if (const int result = writer->wait(); error == 0)
+			error = result;
+
+		writing = false;
+	}
+};
+
+} // json
+
+#endif // JSON_HAS_POSIX_IO
+
+#endif // __JSON_ASYNC_SINK_HPP
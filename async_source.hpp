@@ -0,0 +1,257 @@
+#ifndef __JSON_ASYNC_SOURCE_HPP
+#define __JSON_ASYNC_SOURCE_HPP
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "reader.hpp"
+#include "async_io.hpp"
+
+#ifdef JSON_HAS_POSIX_IO
+
+namespace json
+{
+
+// Reads one buffer from a file descriptor in the background at a time.
+class async_reader
+{
+public:
+	virtual ~async_reader() = default;
+
+	// starts reading up to size bytes into data, which must stay untouched until wait returns
+	virtual void submit(char* data, std::size_t size) = 0;
+
+	// blocks until the submitted read is done, returns the number of bytes read, 0 at the end of
+	// the input, or -errno
+	virtual long wait() = 0;
+};
+
+class thread_reader : public async_reader
+{
+public:
+	explicit thread_reader(const int fd) : fd{ fd }, worker{ [this]() { run(); } } {}
+
+	~thread_reader() override
+	{
+		{
+			std::lock_guard lock{ mutex };
+			stopping = true;
+		}
+
+		cv.notify_all();
+		worker.join();
+	}
+
+	void submit(char* const data, const std::size_t size) override
+	{
+		{
+			std::lock_guard lock{ mutex };
+			pending_data = data;
+			pending_size = size;
+			pending = true;
+		}
+
+		cv.notify_all();
+	}
+
+	long wait() override
+	{
+		std::unique_lock lock{ mutex };
+		cv.wait(lock, [this]() { return !pending; });
+		return result;
+	}
+
+private:
+	int fd;
+	std::mutex mutex;
+	std::condition_variable cv;
+	char* pending_data{};
+	std::size_t pending_size{};
+	bool pending{};
+	bool stopping{};
+	long result{};
+	std::thread worker;
+
+	void run()
+	{
+		std::unique_lock lock{ mutex };
+
+		for (;;)
+		{
+			cv.wait(lock, [this]() { return pending || stopping; });
+
+			if (!pending)
+				return;
+
+			lock.unlock();
+
+			ssize_t n;
+			while ((n = ::read(fd, pending_data, pending_size)) < 0 && errno == EINTR)
+				;
+
+			lock.lock();
+
+			result = n < 0 ? -errno : n;
+			pending = false;
+			cv.notify_all();
+		}
+	}
+};
+
+#ifdef JSON_HAS_IO_URING
+// Reads from explicit offsets when the file is seekable, starting at its position on construction.
+class io_uring_reader : public async_reader
+{
+public:
+	explicit io_uring_reader(const int fd) : fd{ fd }
+	{
+		if (const off_t position = ::lseek(fd, 0, SEEK_CUR); position >= 0)
+		{
+			offset = position;
+			seekable = true;
+		}
+	}
+
+	~io_uring_reader() override { wait(); }
+
+	bool valid() const { return ring.valid(); }
+
+	void submit(char* const data, const std::size_t size) override
+	{
+		iov = iovec{ data, size };
+		enqueue();
+	}
+
+	long wait() override
+	{
+		while (in_flight)
+		{
+			const int n = ring.reap();
+			in_flight = false;
+
+			if (n == -EINTR || n == -EAGAIN)
+			{
+				enqueue();
+				continue;
+			}
+
+			if (n > 0 && seekable)
+				offset += n;
+
+			result = n;
+		}
+
+		return result;
+	}
+
+private:
+	int fd;
+	io_uring_ring ring;
+	iovec iov{};
+	off_t offset{};
+	bool seekable{};
+	bool in_flight{};
+	long result{};
+
+	void enqueue()
+	{
+		if (const int error = ring.submit(IORING_OP_READV, fd, &iov, seekable ? offset : 0); error != 0)
+		{
+			result = -error;
+			return;
+		}
+
+		in_flight = true;
+	}
+};
+#endif // JSON_HAS_IO_URING
+
+// Double buffered source: the next chunk of the file is read in the background while the current
+// one is being parsed, so disk and CPU are busy at the same time. Uses io_uring where the kernel
+// supports it, and a reader thread otherwise. It reads ahead of what has been consumed.
+class async_fd_source : public source
+{
+public:
+	static constexpr std::size_t default_chunk_size = 1 << 20;
+
+	int error{}; // errno of a failed read, after which the input ends
+
+	explicit async_fd_source(const int fd, const std::size_t chunk_size = default_chunk_size, const bool allow_io_uring = true)
+		: size{ chunk_size }, chunks{ std::make_unique<char[]>(chunk_size), std::make_unique<char[]>(chunk_size) }
+	{
+#ifdef JSON_HAS_IO_URING
+		if (allow_io_uring)
+		{
+			if (auto uring = std::make_unique<io_uring_reader>(fd); uring->valid())
+			{
+				reader = std::move(uring);
+				using_io_uring = true;
+			}
+		}
+#endif
+
+		if (!reader)
+			reader = std::make_unique<thread_reader>(fd);
+
+		reader->submit(chunks[1].get(), size);
+	}
+
+	~async_fd_source() override
+	{
+		if (!finished)
+			reader->wait();
+	}
+
+	bool uses_io_uring() const { return using_io_uring; }
+
+	std::size_t read(char* const buffer, const std::size_t n) override
+	{
+		if (available == 0)
+		{
+			if (finished)
+				return 0;
+
+			// the chunk just used up is where the one after next goes
+			const long result = reader->wait();
+
+			if (result <= 0)
+			{
+				if (result < 0)
+					error = static_cast<int>(-result);
+
+				finished = true;
+				return 0;
+			}
+
+			current = 1 - current;
+			consumed = 0;
+			available = static_cast<std::size_t>(result);
+
+			reader->submit(chunks[1 - current].get(), size);
+		}
+
+		const std::size_t count = std::min(n, available);
+		std::memcpy(buffer, chunks[current].get() + consumed, count);
+		consumed += count;
+		available -= count;
+		return count;
+	}
+
+private:
+	std::size_t size;
+	std::unique_ptr<char[]> chunks[2];
+	std::unique_ptr<async_reader> reader;
+	int current{};
+	std::size_t consumed{};
+	std::size_t available{};
+	bool finished{};
+	bool using_io_uring{};
+};
+
+} // json
+
+#endif // JSON_HAS_POSIX_IO
+
+#endif // __JSON_ASYNC_SOURCE_HPP
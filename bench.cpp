@@ -0,0 +1,578 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+
+#include "parser.hpp"
+#include "stringifier.hpp"
+#include "async_sink.hpp"
+#include "async_source.hpp"
+#include "parallel_reader.hpp"
+#include "hash.hpp"
+#include "cache.hpp"
+#include "tracked.hpp"
+#include "tape.hpp"
+#include "patch.hpp"
+#include "compare.hpp"
+#include "allocation_counter.hpp"
+
+// Synthetic corpus benchmark, usage: bench [records] [repetitions] [scalar|sse2|avx2|avx512]
+// The corpus is generated from a fixed seed so that runs (and PGO profiles) are comparable.
+
+struct Point
+{
+	int x, y;
+};
+
+constexpr auto PointDescriptor = std::tuple(
+	json::field("x", &Point::x, json::number),
+	json::field("y", &Point::y, json::number)
+);
+
+struct Order
+{
+	std::uint64_t id;
+	std::string symbol;
+	double price;
+	int quantity;
+	bool active;
+	std::vector<int> fills;
+	std::map<std::string, double> attributes;
+	std::optional<std::string> note;
+	Point origin;
+};
+
+constexpr auto OrderDescriptor = std::tuple(
+	json::field("id", &Order::id, json::number),
+	json::field("symbol", &Order::symbol, json::string),
+	json::field("price", &Order::price, json::number),
+	json::field("quantity", &Order::quantity, json::number),
+	json::field("active", &Order::active, json::boolean),
+	json::field("fills", &Order::fills, json::array{ json::number }),
+	json::field("attributes", &Order::attributes, json::object{ json::number }),
+	json::field("note", &Order::note, json::string),
+	json::field("origin", &Order::origin, PointDescriptor)
+);
+
+constexpr auto OrdersDescriptor = json::array{ OrderDescriptor };
+
+// a large document of which one field changes at a time
+struct Snapshot
+{
+	std::uint64_t tick;
+	std::vector<Order> orders;
+};
+
+constexpr auto SnapshotDescriptor = std::tuple(
+	json::field("tick", &Snapshot::tick, json::number),
+	json::field("orders", &Snapshot::orders, json::array{ OrderDescriptor })
+);
+
+std::vector<Order> make_corpus(const std::size_t records)
+{
+	std::mt19937_64 rng{ 0x5eed };
+
+	const auto uniform = [&rng](const int lo, const int hi) { return std::uniform_int_distribution<int>{ lo, hi }(rng); };
+
+	const auto word = [&](const int min_length, const int max_length) {
+		std::string w(uniform(min_length, max_length), ' ');
+		for (char& c : w)
+			c = static_cast<char>(uniform('a', 'z'));
+		return w;
+	};
+
+	std::vector<Order> corpus(records);
+
+	for (Order& order : corpus)
+	{
+		order.id = rng();
+		order.symbol = word(3, 5);
+		order.price = uniform(1, 1'000'000) / 100.0;
+		order.quantity = uniform(1, 10'000);
+		order.active = uniform(0, 1) != 0;
+
+		for (int i = uniform(0, 8); i > 0; --i)
+			order.fills.push_back(uniform(-1000, 1000));
+
+		for (int i = uniform(0, 4); i > 0; --i)
+			order.attributes[word(4, 12)] = uniform(0, 100'000) / 1000.0;
+
+		if (uniform(0, 3) == 0)
+			order.note = word(10, 60) + "\n\"quoted\"\t" + word(0, 20);
+
+		order.origin = Point{ uniform(-100'000, 100'000), uniform(-100'000, 100'000) };
+	}
+
+	return corpus;
+}
+
+struct measurement
+{
+	double seconds;
+	std::size_t allocations;
+};
+
+template <typename TFunction>
+measurement measure(const int repetitions, TFunction&& function)
+{
+	measurement best{ std::numeric_limits<double>::infinity(), 0 };
+
+	for (int i = 0; i < repetitions; ++i)
+	{
+		json::allocation_guard guard{};
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if (elapsed.count() < best.seconds)
+			best = measurement{ elapsed.count(), guard.count() };
+	}
+
+	return best;
+}
+
+double total_seconds{};
+
+constexpr json::simd::isa isas[] = { json::simd::isa::scalar, json::simd::isa::sse2, json::simd::isa::avx2, json::simd::isa::avx512 };
+
+void report(const std::string& name, const std::size_t bytes, const std::size_t records, const measurement& m)
+{
+	total_seconds += m.seconds;
+
+	std::cout << std::left << std::setw(24) << name << std::right
+		<< std::setw(10) << std::fixed << std::setprecision(2) << m.seconds * 1000 << " ms"
+		<< std::setw(10) << std::setprecision(1) << bytes / m.seconds / (1 << 20) << " MB/s"
+		<< std::setw(10) << std::setprecision(2) << static_cast<double>(m.allocations) / records << " allocs/record\n";
+}
+
+int main(int argc, char const *argv[])
+{
+	const std::size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000;
+	const int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+	if (argc > 3)
+	{
+		const auto isa = std::ranges::find(isas, std::string_view{ argv[3] }, json::simd::name);
+
+		if (isa == std::ranges::end(isas) || !json::simd::force(*isa))
+		{
+			std::cout << "unsupported isa: " << argv[3] << '\n';
+			return 1;
+		}
+	}
+
+	const std::vector<Order> corpus = make_corpus(records);
+
+	json::stringifier stringify{};
+	stringify.dense = true;
+
+	std::vector<std::string> lines;
+	std::size_t line_bytes{};
+
+	for (const Order& order : corpus)
+	{
+		line_bytes += lines.emplace_back(stringify(order, OrderDescriptor)).size();
+	}
+
+	const std::string document = stringify(corpus, json::array{ OrderDescriptor });
+
+	std::cout << "corpus: " << records << " records, " << document.size() << " bytes, " << json::simd::name(json::simd::active()) << " kernels\n";
+
+	bool ok = true;
+
+	{
+		json::parser parse{};
+
+		report("parse/records", line_bytes, records, measure(repetitions, [&]() {
+			for (const std::string& line : lines)
+			{
+				Order order{};
+				ok &= parse(line, order, OrderDescriptor);
+			}
+		}));
+
+		// one long lived value refreshed from every record
+		json::parser update{};
+		update.update = true;
+		Order current{};
+
+		report("parse/update", line_bytes, records, measure(repetitions, [&]() {
+			for (const std::string& line : lines)
+				ok &= update(line, current, OrderDescriptor);
+		}));
+
+		report("parse/document", document.size(), records, measure(repetitions, [&]() {
+			std::vector<Order> orders;
+			ok &= parse(document, orders, json::array{ OrderDescriptor });
+		}));
+
+		// the same document without a schema, parsed into a tape that keeps its memory
+		json::tape tape;
+
+		report("parse/any", document.size(), records, measure(repetitions, [&]() {
+			ok &= parse(document, tape, json::any);
+		}));
+
+		json::stringifier dense{};
+		dense.dense = true;
+
+		report("stringify/any", document.size(), records, measure(repetitions, [&]() {
+			ok &= dense(tape, json::any) == document;
+		}));
+
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "structured-json-bench.jsonl";
+
+		{
+			std::ofstream file{ path, std::ios::binary };
+			for (const std::string& line : lines)
+				file << line << '\n';
+		}
+
+		const std::size_t file_bytes = line_bytes + lines.size();
+
+		report("parse/file-whole", file_bytes, records, measure(repetitions, [&]() {
+			std::ifstream file{ path, std::ios::binary };
+			std::string contents(std::filesystem::file_size(path), '\0');
+			file.read(contents.data(), contents.size());
+			const std::string_view text{ contents };
+
+			for (std::size_t begin = 0, end; begin < text.size(); begin = end + 1)
+			{
+				end = std::min(text.find('\n', begin), text.size());
+				Order order{};
+				ok &= parse(text.substr(begin, end - begin), order, OrderDescriptor);
+			}
+		}));
+
+		report("parse/file-buffered", file_bytes, records, measure(repetitions, [&]() {
+			const int fd = ::open(path.c_str(), O_RDONLY);
+			json::buffered_reader reader{ fd };
+			std::size_t parsed{};
+
+			for (Order order{}; parse(reader, order, OrderDescriptor); order = Order{})
+				parsed++;
+
+			ok &= parsed == records && reader.eof();
+			::close(fd);
+		}));
+
+		for (const bool io_uring : { true, false })
+		{
+			bool uses_io_uring{};
+
+			const measurement m = measure(repetitions, [&]() {
+				const int fd = ::open(path.c_str(), O_RDONLY);
+				auto source = std::make_unique<json::async_fd_source>(fd, json::async_fd_source::default_chunk_size, io_uring);
+				uses_io_uring = source->uses_io_uring();
+
+				json::buffered_reader reader{ std::move(source) };
+				std::size_t parsed{};
+
+				ok &= parse.for_each<Order>(reader, OrderDescriptor, [&](Order&&) { parsed++; });
+				ok &= parsed == records;
+				::close(fd);
+			});
+
+			report(uses_io_uring ? "parse/file-io_uring" : "parse/file-thread", file_bytes, records, m);
+		}
+
+#ifdef JSON_WITH_ZSTD
+		// the same records as zstd frames of about 1MB, one thread against all of them
+		const std::filesystem::path compressed_path = std::filesystem::temp_directory_path() / "structured-json-bench.jsonl.zst";
+
+		{
+			const int fd = ::open(compressed_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			json::fd_sink file{ fd };
+
+			{
+				json::zstd_sink out{ file };
+
+				for (const std::string& line : lines)
+				{
+					out << line << '\n';
+
+					if (out.frame_size() >= 1 << 20)
+						out.end_frame();
+				}
+			}
+
+			file.flush();
+			::close(fd);
+		}
+
+		report("parse/zstd", file_bytes, records, measure(repetitions, [&]() {
+			const int fd = ::open(compressed_path.c_str(), O_RDONLY);
+			json::buffered_reader reader{ json::decompressing_source(std::make_unique<json::fd_source>(fd)) };
+			std::size_t parsed{};
+
+			ok &= parse.for_each<Order>(reader, OrderDescriptor, [&](Order&&) { parsed++; });
+			ok &= parsed == records;
+			::close(fd);
+		}));
+
+		report("parse/zstd-parallel", file_bytes, records, measure(repetitions, [&]() {
+			const int fd = ::open(compressed_path.c_str(), O_RDONLY);
+			std::size_t parsed{};
+
+			ok &= json::parallel_for_each<Order>(std::make_unique<json::fd_source>(fd), OrderDescriptor, [&](Order&&) { parsed++; });
+			ok &= parsed == records;
+			::close(fd);
+		}));
+
+		std::filesystem::remove(compressed_path);
+#endif
+
+		std::filesystem::remove(path);
+	}
+
+	{
+		json::stringifier dense{};
+		dense.dense = true;
+
+		report("stringify/dense", document.size(), records, measure(repetitions, [&]() {
+			ok &= !dense(corpus, json::array{ OrderDescriptor }).empty();
+		}));
+
+		// the same document served again and again without changing
+		const json::cached cached_corpus{ corpus, json::array{ OrderDescriptor } };
+		std::ostringstream served;
+
+		report("stringify/cached", document.size(), records, measure(repetitions, [&]() {
+			served.str({});
+			cached_corpus.write(served, dense);
+		}));
+
+		ok &= served.str() == document;
+
+		json::tracked<Snapshot, decltype(SnapshotDescriptor)> snapshot{ Snapshot{ 0, corpus }, SnapshotDescriptor };
+		std::string snapshot_text;
+
+		report("stringify/tracked", document.size(), records, measure(repetitions, [&]() {
+			snapshot.modify(&Snapshot::tick)++;
+			snapshot_text = dense(snapshot, SnapshotDescriptor);
+		}));
+
+		ok &= snapshot_text == dense(*snapshot, SnapshotDescriptor);
+
+		json::stringifier pretty{};
+		pretty.pretty = true;
+
+		report("stringify/pretty", document.size(), records, measure(repetitions, [&]() {
+			ok &= !pretty(corpus, json::array{ OrderDescriptor }).empty();
+		}));
+
+		json::stringifier canonical{};
+		canonical.canonical = true;
+
+		report("stringify/canonical", document.size(), records, measure(repetitions, [&]() {
+			ok &= !canonical(corpus, json::array{ OrderDescriptor }).empty();
+		}));
+
+		static constexpr auto OrdersDescriptor = json::array{ OrderDescriptor };
+
+		report("stringify/canonical-static", document.size(), records, measure(repetitions, [&]() {
+			ok &= !canonical.operator()<OrdersDescriptor>(corpus).empty();
+		}));
+
+		// the attributes again, held in unordered maps and written in key order
+		std::vector<std::unordered_map<std::string, double>> attributes;
+
+		for (const Order& order : corpus)
+			attributes.emplace_back(order.attributes.begin(), order.attributes.end());
+
+		json::stringifier sorted{};
+		sorted.dense = true;
+		sorted.sorted = true;
+
+		constexpr auto AttributesDescriptor = json::array{ json::object{ json::number } };
+		const std::size_t attribute_bytes = sorted(attributes, AttributesDescriptor).size();
+
+		report("stringify/sorted-map", attribute_bytes, records, measure(repetitions, [&]() {
+			ok &= sorted(attributes, AttributesDescriptor).size() == attribute_bytes;
+		}));
+
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "structured-json-bench-out.jsonl";
+
+		report("stringify/ofstream", line_bytes, records, measure(repetitions, [&]() {
+			std::ofstream file{ path, std::ios::binary };
+			for (const Order& order : corpus)
+			{
+				dense(file, order, OrderDescriptor);
+				file << '\n';
+			}
+		}));
+
+		report("stringify/fd-sink", line_bytes, records, measure(repetitions, [&]() {
+			const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			json::fd_sink sink{ fd };
+			for (const Order& order : corpus)
+			{
+				dense(sink, order, OrderDescriptor);
+				sink.put('\n');
+			}
+			sink.flush();
+			ok &= sink.good();
+			::close(fd);
+		}));
+
+		for (const bool io_uring : { true, false })
+		{
+			const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			bool uses_io_uring{};
+
+			const measurement m = measure(repetitions, [&]() {
+				::ftruncate(fd, 0);
+				::lseek(fd, 0, SEEK_SET);
+
+				json::async_fd_sink sink{ fd, json::async_fd_sink::default_buffer_size, io_uring };
+				for (const Order& order : corpus)
+				{
+					dense(sink, order, OrderDescriptor);
+					sink.put('\n');
+				}
+				sink.finish();
+				ok &= sink.good();
+				uses_io_uring = sink.uses_io_uring();
+			});
+
+			::close(fd);
+			report(uses_io_uring ? "stringify/io_uring-sink" : "stringify/thread-sink", line_bytes, records, m);
+		}
+
+		std::filesystem::remove(path);
+
+		std::stringstream ss;
+
+		report("stringify/records", line_bytes, records, measure(repetitions, [&]() {
+			ss.str({});
+			for (const Order& order : corpus)
+			{
+				dense(ss, order, OrderDescriptor);
+				ss << '\n';
+			}
+		}));
+
+		// deduplicating by content: hashing the stringified record against hashing it directly
+		std::uint64_t checksum{};
+
+		report("hash/stringified", line_bytes, records, measure(repetitions, [&]() {
+			for (const Order& order : corpus)
+				checksum += std::hash<std::string>{}(dense(order, OrderDescriptor));
+		}));
+
+		report("hash/records", line_bytes, records, measure(repetitions, [&]() {
+			for (const Order& order : corpus)
+				checksum += json::hash(order, OrderDescriptor);
+		}));
+
+		ok &= checksum != 0;
+
+		// change detection: comparing stringified records against comparing them directly
+		const std::vector<Order> copy = corpus;
+		std::size_t same{};
+
+		report("compare/stringified", line_bytes, records, measure(repetitions, [&]() {
+			for (std::size_t i = 0; i < records; i++)
+				same += dense(corpus[i], OrderDescriptor) == dense(copy[i], OrderDescriptor);
+		}));
+
+		report("compare/records", line_bytes, records, measure(repetitions, [&]() {
+			for (std::size_t i = 0; i < records; i++)
+				same += json::equal(corpus[i], copy[i], OrderDescriptor);
+		}));
+
+		ok &= same == 2 * records * repetitions;
+	}
+
+	{
+		// the prices alone, into doubles, into decimals and as text
+		std::vector<std::string> prices;
+		std::size_t price_bytes{};
+
+		for (const Order& order : corpus)
+			price_bytes += prices.emplace_back(stringify(order.price, json::number)).size();
+
+		json::parser parse{};
+
+		report("parse/number", price_bytes, records, measure(repetitions, [&]() {
+			for (const std::string& text : prices)
+			{
+				double price{};
+				ok &= parse(text, price, json::number);
+			}
+		}));
+
+		report("parse/decimal", price_bytes, records, measure(repetitions, [&]() {
+			for (const std::string& text : prices)
+			{
+				std::int64_t price{};
+				ok &= parse(text, price, json::decimal<8, json::rounding::half_even>);
+			}
+		}));
+
+		// and kept as they're written
+		report("parse/number-text", price_bytes, records, measure(repetitions, [&]() {
+			for (const std::string& text : prices)
+			{
+				char price[32];
+				ok &= parse(text, price, json::number);
+			}
+		}));
+	}
+
+	{
+		// a stream of small patches replayed against the corpus
+		std::vector<std::string> patches;
+		std::size_t patch_bytes{};
+
+		for (std::size_t i = 0; i < records; i++)
+		{
+			const std::string& patch = patches.emplace_back("[{\"op\":\"replace\",\"path\":\"/" + std::to_string(i)
+				+ "/price\",\"value\":" + std::to_string(i % 1000) + ".5},{\"op\":\"add\",\"path\":\"/" + std::to_string(i) + "/fills/-\",\"value\":1}]");
+			patch_bytes += patch.size();
+		}
+
+		std::vector<Order> state = corpus;
+		json::patcher patch{};
+
+		report("patch/apply", patch_bytes, records, measure(repetitions, [&]() {
+			for (const std::string& text : patches)
+				ok &= patch(text, state, json::array{ OrderDescriptor });
+		}));
+
+		// with field names found through tables sorted at compile time
+		report("patch/apply-static", patch_bytes, records, measure(repetitions, [&]() {
+			for (const std::string& text : patches)
+				ok &= patch.operator()<OrdersDescriptor>(text, state);
+		}));
+
+		// and the patches that take each record back to where it started
+		json::differ diff{};
+		std::string delta;
+
+		report("patch/diff", line_bytes, records, measure(repetitions, [&]() {
+			for (std::size_t i = 0; i < records; i++)
+				delta = diff(state[i], corpus[i], OrderDescriptor);
+		}));
+
+		ok &= delta.find("\"op\":\"replace\"") != std::string::npos;
+	}
+
+	std::cout << "total: " << std::fixed << std::setprecision(2) << total_seconds * 1000 << " ms\n";
+
+	if (!ok)
+	{
+		std::cout << "benchmark produced invalid results\n";
+		return 1;
+	}
+}
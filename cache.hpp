@@ -0,0 +1,100 @@
+#ifndef __JSON_CACHE_HPP
+#define __JSON_CACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+#include "json.hpp"
+#include "stringifier.hpp"
+
+namespace json
+{
+
+// Holds a value along with its stringified form, so values that are written much more often than
+// they change (configuration, reference data) are only stringified again after a change. One form
+// is kept per combination of the stringifier's formatting flags.
+//
+// Changes go through modify() or are followed by invalidate(). Readers on other threads may call
+// str() and write() at the same time, but not while the value is being changed.
+template <typename T, Descriptor TDesc>
+class cached
+{
+public:
+	cached(T value, const TDesc& descriptor) : current{ std::move(value) }, descriptor{ descriptor } {}
+
+	cached(const cached&) = delete;
+	cached& operator=(const cached&) = delete;
+
+	const T& value() const { return current; }
+	const T& operator*() const { return current; }
+	const T* operator->() const { return &current; }
+
+	// invalidates the stringified forms and hands out the value to be changed right away
+	T& modify()
+	{
+		invalidate();
+		return current;
+	}
+
+	// for a value that was changed by other means
+	void invalidate()
+	{
+		std::lock_guard lock{ mutex };
+
+		for (auto& text : texts)
+			text.reset();
+
+		generation++;
+	}
+
+	// goes up with every invalidation, to tell whether copies taken earlier are out of date
+	std::uint64_t version() const { return generation; }
+
+	// the value stringified with format's flags, stringifying it only if it isn't cached yet. The
+	// string stays valid after an invalidation for as long as it is held.
+	std::shared_ptr<const std::string> str(const stringifier& format = {}) const
+	{
+		std::lock_guard lock{ mutex };
+		std::shared_ptr<const std::string>& text = texts[format_index(format)];
+
+		if (!text)
+		{
+			stringifier stringify = format;
+			text = std::make_shared<const std::string>(stringify(current, descriptor));
+		}
+
+		return text;
+	}
+
+	void write(std::ostream& os, const stringifier& format = {}) const
+	{
+		const auto text = str(format);
+		os.write(text->data(), static_cast<std::streamsize>(text->size()));
+	}
+
+	void write(sink& os, const stringifier& format = {}) const
+	{
+		const auto text = str(format);
+		os.write(text->data(), text->size());
+	}
+
+private:
+	T current;
+	TDesc descriptor;
+	mutable std::mutex mutex;
+	mutable std::shared_ptr<const std::string> texts[9];
+	std::atomic<std::uint64_t> generation{};
+
+	static std::size_t format_index(const stringifier& format)
+	{
+		return format.canonical ? 8 : (format.dense ? 1 : 0) | (format.pretty ? 2 : 0) | (format.sorted ? 4 : 0);
+	}
+};
+
+} // json
+
+#endif // __JSON_CACHE_HPP
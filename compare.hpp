@@ -0,0 +1,243 @@
+#ifndef __JSON_COMPARE_HPP
+#define __JSON_COMPARE_HPP
+
+#include <compare>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include <ranges>
+#include <type_traits>
+
+#include "json.hpp"
+#include "reflection.hpp"
+#include "tape.hpp"
+
+namespace json
+{
+
+// Compares values through their descriptor, looking only at the described members. Empty optionals
+// (null) are equal to each other and come before any value. Booleans, numbers and strings compare the
+// usual way, strings in char[N] stopping at the terminator. Arrays and objects compare their elements
+// in order, then their sizes, except unordered maps, which are equal when they hold the same keys and
+// values and are otherwise unordered. Values of the any descriptor and numbers kept as text are equal
+// when they were written the same, and otherwise unordered too.
+struct comparer
+{
+public:
+	bool equal(const auto& a, const auto& b, const auto& descriptor)
+	{
+		return equal_to(a, b, descriptor);
+	}
+
+	std::partial_ordering compare(const auto& a, const auto& b, const auto& descriptor)
+	{
+		return order(a, b, descriptor);
+	}
+
+private:
+	template <typename T>
+	static constexpr bool is_unordered_map_v = requires { typename T::hasher; typename T::mapped_type; };
+
+	template <typename T>
+	static std::string_view view(const T& value)
+	{
+		if constexpr (std::is_same_v<T, char>)
+			return std::string_view{ &value, 1 };
+		else if constexpr (std::is_same_v<T, const char*>)
+			return std::string_view{ value };
+		else if constexpr (std::is_bounded_array_v<T>)
+			return std::string_view{ value, static_cast<std::size_t>(std::find(value, value + std::extent_v<T>, '\0') - value) };
+		else
+			return std::string_view{ std::ranges::data(value), std::ranges::size(value) };
+	}
+
+	// =====
+
+	template <typename T, Descriptor TDesc>
+	bool equal_to(const std::optional<T>& a, const std::optional<T>& b, const TDesc& descriptor)
+	{
+		return a && b ? equal_to(*a, *b, descriptor) : a.has_value() == b.has_value();
+	}
+
+	template <Boolean T> requires (Mandatory<T>)
+	bool equal_to(const T& a, const T& b, const boolean_t&)
+	{
+		return (a ? true : false) == (b ? true : false);
+	}
+
+	template <Number T>
+	bool equal_to(const T& a, const T& b, const number_t&)
+	{
+		return a == b;
+	}
+
+	template <NumberText T>
+	bool equal_to(const T& a, const T& b, const number_t&)
+	{
+		return view(a) == view(b);
+	}
+
+	template <std::integral T, int Scale, rounding Rounding>
+	bool equal_to(const T& a, const T& b, const decimal_t<Scale, Rounding>&)
+	{
+		return a == b;
+	}
+
+	template <String T> requires (Mandatory<T>)
+	bool equal_to(const T& a, const T& b, const string_t&)
+	{
+		if constexpr (std::is_same_v<T, char> || std::is_same_v<T, const char*> || std::is_bounded_array_v<T> || std::ranges::contiguous_range<T>)
+			return view(a) == view(b);
+		else
+			return std::ranges::equal(a, b);
+	}
+
+	bool equal_to(const tape& a, const tape& b, const any_t&)
+	{
+		return a == b;
+	}
+
+	// contiguous integers are compared with memcmp, which is vectorised
+	template <Array T, typename TValueDesc> requires (Mandatory<T>)
+	bool equal_to(const T& a, const T& b, const array<TValueDesc>& descriptor)
+	{
+		using value_type = underlying_value_type_t<T>;
+
+		if constexpr (std::ranges::contiguous_range<T> && std::is_integral_v<value_type> && !std::is_same_v<value_type, bool> && std::is_same_v<TValueDesc, number_t>)
+		{
+			const std::size_t size = std::ranges::size(a);
+			return size == std::ranges::size(b) && (size == 0 || std::memcmp(std::ranges::data(a), std::ranges::data(b), size * sizeof(value_type)) == 0);
+		}
+		else
+		{
+			return std::ranges::equal(a, b, [&](const auto& x, const auto& y) {
+				return equal_to(x, y, descriptor.value_descriptor);
+			});
+		}
+	}
+
+	template <typename T, typename TValueDesc> requires (Mandatory<T>)
+	bool equal_to(const T& a, const T& b, const object<TValueDesc>& descriptor)
+	{
+		if constexpr (is_unordered_map_v<T>)
+		{
+			return a.size() == b.size() && std::ranges::all_of(a, [&](const auto& entry) {
+				const auto match = b.find(entry.first);
+				return match != b.end() && equal_to(entry.second, match->second, descriptor.value_descriptor);
+			});
+		}
+		else
+		{
+			return std::ranges::equal(a, b, [&](const auto& x, const auto& y) {
+				return view(x.first) == view(y.first) && equal_to(x.second, y.second, descriptor.value_descriptor);
+			});
+		}
+	}
+
+	template <typename T, typename TMembers> requires (Mandatory<T> && (is_field_list_v<TMembers> || is_element_list_v<TMembers>))
+	bool equal_to(const T& a, const T& b, const TMembers& members)
+	{
+		return for_each_member(members, [&](const auto& member) {
+			return equal_to(a.*member.member_ptr, b.*member.member_ptr, member.descriptor);
+		});
+	}
+
+	// =====
+
+	template <typename T, Descriptor TDesc>
+	std::partial_ordering order(const std::optional<T>& a, const std::optional<T>& b, const TDesc& descriptor)
+	{
+		return a && b ? order(*a, *b, descriptor) : a.has_value() <=> b.has_value();
+	}
+
+	template <Boolean T> requires (Mandatory<T>)
+	std::partial_ordering order(const T& a, const T& b, const boolean_t&)
+	{
+		return (a ? true : false) <=> (b ? true : false);
+	}
+
+	template <Number T>
+	std::partial_ordering order(const T& a, const T& b, const number_t&)
+	{
+		return a <=> b;
+	}
+
+	template <NumberText T>
+	std::partial_ordering order(const T& a, const T& b, const number_t&)
+	{
+		return view(a) == view(b) ? std::partial_ordering::equivalent : std::partial_ordering::unordered;
+	}
+
+	template <std::integral T, int Scale, rounding Rounding>
+	std::partial_ordering order(const T& a, const T& b, const decimal_t<Scale, Rounding>&)
+	{
+		return a <=> b;
+	}
+
+	template <String T> requires (Mandatory<T>)
+	std::partial_ordering order(const T& a, const T& b, const string_t&)
+	{
+		if constexpr (std::is_same_v<T, char> || std::is_same_v<T, const char*> || std::is_bounded_array_v<T> || std::ranges::contiguous_range<T>)
+			return view(a) <=> view(b);
+		else
+			return std::lexicographical_compare_three_way(std::ranges::begin(a), std::ranges::end(a), std::ranges::begin(b), std::ranges::end(b));
+	}
+
+	std::partial_ordering order(const tape& a, const tape& b, const any_t&)
+	{
+		return a == b ? std::partial_ordering::equivalent : std::partial_ordering::unordered;
+	}
+
+	template <Array T, typename TValueDesc> requires (Mandatory<T>)
+	std::partial_ordering order(const T& a, const T& b, const array<TValueDesc>& descriptor)
+	{
+		return std::lexicographical_compare_three_way(std::ranges::begin(a), std::ranges::end(a), std::ranges::begin(b), std::ranges::end(b), [&](const auto& x, const auto& y) {
+			return order(x, y, descriptor.value_descriptor);
+		});
+	}
+
+	template <typename T, typename TValueDesc> requires (Mandatory<T>)
+	std::partial_ordering order(const T& a, const T& b, const object<TValueDesc>& descriptor)
+	{
+		if constexpr (is_unordered_map_v<T>)
+		{
+			return equal_to(a, b, descriptor) ? std::partial_ordering::equivalent : std::partial_ordering::unordered;
+		}
+		else
+		{
+			return std::lexicographical_compare_three_way(std::ranges::begin(a), std::ranges::end(a), std::ranges::begin(b), std::ranges::end(b), [&](const auto& x, const auto& y) {
+				const std::partial_ordering keys = view(x.first) <=> view(y.first);
+				return keys != 0 ? keys : order(x.second, y.second, descriptor.value_descriptor);
+			});
+		}
+	}
+
+	template <typename T, typename TMembers> requires (Mandatory<T> && (is_field_list_v<TMembers> || is_element_list_v<TMembers>))
+	std::partial_ordering order(const T& a, const T& b, const TMembers& members)
+	{
+		std::partial_ordering result = std::partial_ordering::equivalent;
+
+		for_each_member(members, [&](const auto& member) {
+			result = order(a.*member.member_ptr, b.*member.member_ptr, member.descriptor);
+			return result == 0;
+		});
+
+		return result;
+	}
+};
+
+// whether a and b are the same as far as descriptor goes, see comparer
+inline bool equal(const auto& a, const auto& b, const auto& descriptor)
+{
+	return comparer{}.equal(a, b, descriptor);
+}
+
+// how a and b order as far as descriptor goes, see comparer
+inline std::partial_ordering compare(const auto& a, const auto& b, const auto& descriptor)
+{
+	return comparer{}.compare(a, b, descriptor);
+}
+
+} // json
+
+#endif // __JSON_COMPARE_HPP
@@ -0,0 +1,409 @@
+#ifndef __JSON_COMPRESSION_HPP
+#define __JSON_COMPRESSION_HPP
+
+// Decompressing sources for the buffered_reader and compressing sinks for the stringifier, so
+// compressed files are processed in one pass. zlib and zstd are optional: define JSON_WITH_ZLIB
+// and/or JSON_WITH_ZSTD and link against them (the CMake target does both when they're found).
+
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+
+#include "reader.hpp"
+#include "sink.hpp"
+
+#ifdef JSON_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef JSON_WITH_ZSTD
+#include <zstd.h>
+#include <zstd_errors.h>
+#endif
+
+namespace json
+{
+
+// replays some bytes already taken from a source before carrying on with it
+class prefixed_source : public source
+{
+public:
+	prefixed_source(std::unique_ptr<source> src, const char* const prefix, const std::size_t prefix_size)
+		: src{ std::move(src) }, prefix_size{ std::min(prefix_size, sizeof(prefix)) }
+	{
+		std::memcpy(this->prefix, prefix, this->prefix_size);
+	}
+
+	std::size_t read(char* const buffer, const std::size_t size) override
+	{
+		if (replayed == prefix_size)
+			return src->read(buffer, size);
+
+		const std::size_t count = std::min(size, prefix_size - replayed);
+		std::memcpy(buffer, prefix + replayed, count);
+		replayed += count;
+		return count;
+	}
+
+private:
+	std::unique_ptr<source> src;
+	char prefix[8];
+	std::size_t prefix_size;
+	std::size_t replayed{};
+};
+
+#ifdef JSON_WITH_ZLIB
+// Inflates gzip or zlib data, including concatenated gzip members.
+class gzip_source : public source
+{
+public:
+	static constexpr std::size_t default_buffer_size = 1 << 16;
+
+	int error{ Z_OK }; // zlib error, Z_DATA_ERROR if the input is cut short
+
+	explicit gzip_source(std::unique_ptr<source> compressed, const std::size_t buffer_size = default_buffer_size)
+		: compressed{ std::move(compressed) }, size{ buffer_size }, input{ std::make_unique<char[]>(buffer_size) }
+	{
+		// 32 asks zlib to detect the gzip or zlib header
+		if (inflateInit2(&stream, 15 + 32) != Z_OK)
+			error = Z_MEM_ERROR;
+	}
+
+	~gzip_source() override { inflateEnd(&stream); }
+
+	std::size_t read(char* const buffer, const std::size_t n) override
+	{
+		const uInt wanted = static_cast<uInt>(std::min<std::size_t>(n, std::numeric_limits<uInt>::max()));
+		stream.next_out = reinterpret_cast<Bytef*>(buffer);
+		stream.avail_out = wanted;
+
+		while (error == Z_OK)
+		{
+			if (between_members)
+			{
+				if (stream.avail_in == 0 && !fill())
+					break;
+
+				inflateReset(&stream);
+				between_members = false;
+			}
+
+			if (const int result = inflate(&stream, Z_NO_FLUSH); result == Z_STREAM_END)
+				between_members = true;
+			else if (result != Z_OK && result != Z_BUF_ERROR)
+				error = result;
+
+			if (stream.avail_out != wanted)
+				break;
+
+			if (!between_members && stream.avail_in == 0 && !fill())
+				error = Z_DATA_ERROR;
+		}
+
+		return wanted - stream.avail_out;
+	}
+
+private:
+	std::unique_ptr<source> compressed;
+	std::size_t size;
+	std::unique_ptr<char[]> input;
+	z_stream stream{};
+	bool between_members{ true };
+
+	bool fill()
+	{
+		const std::size_t n = compressed->read(input.get(), std::min<std::size_t>(size, std::numeric_limits<uInt>::max()));
+		stream.next_in = reinterpret_cast<Bytef*>(input.get());
+		stream.avail_in = static_cast<uInt>(n);
+		return n != 0;
+	}
+};
+
+// Deflates everything written to it as gzip into another sink.
+class gzip_sink : public sink
+{
+public:
+	static constexpr std::size_t default_buffer_size = 1 << 16;
+
+	int error{ Z_OK };
+
+	explicit gzip_sink(sink& out, const int level = Z_DEFAULT_COMPRESSION, const std::size_t buffer_size = default_buffer_size)
+		: out{ out }, buffer{ std::make_unique<char[]>(buffer_size) }
+	{
+		// 16 asks for a gzip header rather than a zlib one
+		if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			error = Z_MEM_ERROR;
+
+		set_buffer(buffer.get(), buffer_size);
+	}
+
+	~gzip_sink() override
+	{
+		finish();
+		deflateEnd(&stream);
+	}
+
+	// compresses whatever is left, ends the gzip stream and flushes the output sink
+	void finish()
+	{
+		if (finished)
+			return;
+
+		flush();
+		compress(Z_FINISH);
+		out.flush();
+		finished = true;
+	}
+
+	bool good() const { return error == Z_OK; }
+
+protected:
+	void flush_buffer() override
+	{
+		compress(Z_NO_FLUSH);
+		pos = first;
+	}
+
+private:
+	sink& out;
+	std::unique_ptr<char[]> buffer;
+	z_stream stream{};
+	bool finished{};
+
+	void compress(const int mode)
+	{
+		if (error != Z_OK)
+			return;
+
+		stream.next_in = reinterpret_cast<Bytef*>(first);
+		stream.avail_in = static_cast<uInt>(pos - first);
+
+		for (;;)
+		{
+			char chunk[1 << 14];
+			stream.next_out = reinterpret_cast<Bytef*>(chunk);
+			stream.avail_out = sizeof(chunk);
+
+			const int result = deflate(&stream, mode);
+
+			if (result == Z_STREAM_ERROR)
+			{
+				error = result;
+				return;
+			}
+
+			out.write(chunk, sizeof(chunk) - stream.avail_out);
+
+			if (mode == Z_FINISH ? result == Z_STREAM_END : stream.avail_in == 0 && stream.avail_out != 0)
+				return;
+		}
+	}
+};
+#endif // JSON_WITH_ZLIB
+
+#ifdef JSON_WITH_ZSTD
+// Decompresses a zstd stream of one or more frames.
+class zstd_source : public source
+{
+public:
+	static constexpr std::size_t default_buffer_size = 1 << 17;
+
+	std::size_t error{}; // zstd error code, check with ZSTD_getErrorName
+
+	explicit zstd_source(std::unique_ptr<source> compressed, const std::size_t buffer_size = default_buffer_size)
+		: compressed{ std::move(compressed) }, size{ buffer_size }, buffer{ std::make_unique<char[]>(buffer_size) }, context{ ZSTD_createDCtx() }
+	{
+	}
+
+	~zstd_source() override { ZSTD_freeDCtx(context); }
+
+	// true if the input was cut short or isn't zstd
+	bool failed() const { return error != 0; }
+
+	// decompresses another stream, keeping the context and buffer
+	void reset(std::unique_ptr<source> next)
+	{
+		compressed = std::move(next);
+		ZSTD_DCtx_reset(context, ZSTD_reset_session_only);
+		error = 0;
+		input = ZSTD_inBuffer{ nullptr, 0, 0 };
+		frame_complete = true;
+	}
+
+	std::size_t read(char* const data, const std::size_t n) override
+	{
+		ZSTD_outBuffer output{ data, n, 0 };
+
+		while (!failed())
+		{
+			const std::size_t consumed = input.pos;
+			const std::size_t result = ZSTD_decompressStream(context, &output, &input);
+
+			if (ZSTD_isError(result))
+			{
+				error = result;
+				break;
+			}
+
+			// a call that does nothing after a frame ends asks for the next header
+			if (input.pos != consumed || output.pos != 0)
+				frame_complete = result == 0;
+
+			if (output.pos != 0)
+				break;
+
+			if (input.pos == input.size && !fill())
+			{
+				if (!frame_complete)
+					error = static_cast<std::size_t>(-ZSTD_error_srcSize_wrong);
+				break;
+			}
+		}
+
+		return output.pos;
+	}
+
+private:
+	std::unique_ptr<source> compressed;
+	std::size_t size;
+	std::unique_ptr<char[]> buffer;
+	ZSTD_DCtx* context;
+	ZSTD_inBuffer input{ nullptr, 0, 0 };
+	bool frame_complete{ true };
+
+	bool fill()
+	{
+		input = ZSTD_inBuffer{ buffer.get(), compressed->read(buffer.get(), size), 0 };
+		return input.size != 0;
+	}
+};
+
+// Compresses everything written to it as zstd into another sink.
+class zstd_sink : public sink
+{
+public:
+	static constexpr std::size_t default_buffer_size = 1 << 17;
+
+	std::size_t error{}; // zstd error code, check with ZSTD_getErrorName
+
+	explicit zstd_sink(sink& out, const int level = ZSTD_CLEVEL_DEFAULT, const std::size_t buffer_size = default_buffer_size)
+		: out{ out }, buffer{ std::make_unique<char[]>(buffer_size) }, context{ ZSTD_createCCtx() }
+	{
+		ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, level);
+		set_buffer(buffer.get(), buffer_size);
+	}
+
+	~zstd_sink() override
+	{
+		finish();
+		ZSTD_freeCCtx(context);
+	}
+
+	// compresses whatever is left, ends the frame and flushes the output sink
+	void finish()
+	{
+		if (finished)
+			return;
+
+		// no empty frame after one ended by end_frame
+		if (frames == 0 || frame_size() != 0)
+			end_frame();
+
+		out.flush();
+		finished = true;
+	}
+
+	// Ends the current frame, the next write starts a new one. Frames are decompressed
+	// independently, so ending them between records lets parallel_for_each spread them over threads.
+	void end_frame()
+	{
+		flush();
+		compress(ZSTD_e_end);
+		frame_bytes = 0;
+		frames++;
+	}
+
+	// uncompressed bytes written since the current frame started
+	std::size_t frame_size() const { return frame_bytes + static_cast<std::size_t>(pos - first); }
+
+	bool good() const { return error == 0; }
+
+protected:
+	void flush_buffer() override
+	{
+		compress(ZSTD_e_continue);
+		frame_bytes += pos - first;
+		pos = first;
+	}
+
+private:
+	sink& out;
+	std::unique_ptr<char[]> buffer;
+	ZSTD_CCtx* context;
+	std::size_t frame_bytes{};
+	std::size_t frames{};
+	bool finished{};
+
+	void compress(const ZSTD_EndDirective mode)
+	{
+		if (error != 0)
+			return;
+
+		ZSTD_inBuffer input{ first, static_cast<std::size_t>(pos - first), 0 };
+
+		for (;;)
+		{
+			char chunk[1 << 14];
+			ZSTD_outBuffer output{ chunk, sizeof(chunk), 0 };
+
+			const std::size_t remaining = ZSTD_compressStream2(context, &output, &input, mode);
+
+			if (ZSTD_isError(remaining))
+			{
+				error = remaining;
+				return;
+			}
+
+			out.write(chunk, output.pos);
+
+			if (mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size)
+				return;
+		}
+	}
+};
+#endif // JSON_WITH_ZSTD
+
+// Looks at the first bytes of the source and decompresses it if it's gzip or zstd (and support
+// for it is compiled in), otherwise passes it through untouched.
+inline std::unique_ptr<source> decompressing_source(std::unique_ptr<source> src)
+{
+	char magic[4];
+	std::size_t n{};
+
+	while (n < sizeof(magic))
+	{
+		const std::size_t count = src->read(magic + n, sizeof(magic) - n);
+		if (count == 0)
+			break;
+		n += count;
+	}
+
+	auto replayed = std::make_unique<prefixed_source>(std::move(src), magic, n);
+
+#ifdef JSON_WITH_ZLIB
+	if (n >= 2 && magic[0] == '\x1f' && magic[1] == '\x8b')
+		return std::make_unique<gzip_source>(std::move(replayed));
+#endif
+
+#ifdef JSON_WITH_ZSTD
+	if (n == 4 && std::memcmp(magic, "\x28\xb5\x2f\xfd", 4) == 0)
+		return std::make_unique<zstd_source>(std::move(replayed));
+#endif
+
+	return replayed;
+}
+
+} // json
+
+#endif // __JSON_COMPRESSION_HPP
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstdlib>
+
+#include "parser.hpp"
+#include "stringifier.hpp"
+
+// Fuzz target, links against libFuzzer when JSON_LIBFUZZER is defined. Otherwise it builds a
+// standalone driver: fuzz [files...] replays the given inputs, and without arguments it runs a
+// fixed number of random mutations of the built-in seeds.
+
+struct Point
+{
+	int x, y;
+
+	auto operator<=>(const Point&) const = default;
+};
+
+constexpr auto PointDescriptor = std::tuple(
+	json::field("x", &Point::x, json::number),
+	json::field("y", &Point::y, json::number)
+);
+
+struct Person
+{
+	std::string name;
+	long long age;
+	bool active;
+
+	auto operator<=>(const Person&) const = default;
+};
+
+constexpr auto PersonDescriptor = std::tuple(
+	json::element(&Person::name, json::string),
+	json::element(&Person::age, json::number),
+	json::element(&Person::active, json::boolean)
+);
+
+struct Shape
+{
+	std::string name;
+	std::vector<Point> points;
+	std::map<std::string, std::vector<int>> tags;
+	std::optional<Person> owner;
+	char code[8];
+	bool closed;
+
+	auto operator<=>(const Shape&) const = default;
+};
+
+constexpr auto ShapeDescriptor = std::tuple(
+	json::field("name", &Shape::name, json::string),
+	json::field("points", &Shape::points, json::array{ PointDescriptor }),
+	json::field("tags", &Shape::tags, json::object{ json::array{ json::number } }),
+	json::field("owner", &Shape::owner, PersonDescriptor),
+	json::field("code", &Shape::code, json::string),
+	json::field("closed", &Shape::closed, json::boolean)
+);
+
+// anything that parses must stringify to something that parses back to the same value
+template <typename T>
+void round_trip(const std::string& text, const auto& descriptor)
+{
+	json::parser parse{};
+	T value{};
+
+	if (!parse(text, value, descriptor))
+		return;
+
+	json::stringifier stringify{};
+	const std::string output = stringify(value, descriptor);
+
+	T reparsed{};
+
+	if (!parse(output, reparsed, descriptor) || !(reparsed == value))
+	{
+		std::cerr << "round trip failed\ninput:  " << text << "\noutput: " << output << '\n';
+		std::abort();
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+	if (size == 0)
+		return 0;
+
+	const std::string text(reinterpret_cast<const char*>(data), size);
+
+	round_trip<Point>(text, PointDescriptor);
+	round_trip<Person>(text, PersonDescriptor);
+	round_trip<Shape>(text, ShapeDescriptor);
+	round_trip<std::vector<std::string>>(text, json::array{ json::string });
+	round_trip<std::map<std::string, std::optional<long long>>>(text, json::object{ json::number });
+	round_trip<json::tape>(text, json::any);
+
+	json::parser parse{};
+	std::vector<double> numbers;
+	parse(text, numbers, json::array{ json::number });
+
+	return 0;
+}
+
+#ifndef JSON_LIBFUZZER
+
+const char* seeds[] = {
+	"{\"x\":3,\"y\":4}",
+	"[\"Steve\",25,true]",
+	"{\"name\":\"tri\\u0041ngle\",\"points\":[{\"x\":0,\"y\":0},{\"x\":1,\"y\":0},{\"x\":0,\"y\":1}],"
+		"\"tags\":{\"a\":[1,2],\"b\":[]},\"owner\":[\"Steve\",25,false],\"code\":\"abc\",\"closed\":true}",
+	"{\"name\":\"line\",\"points\":[],\"tags\":{},\"owner\":null,\"code\":\"toolongcode\",\"closed\":false}",
+	"[\"yes\",\"no\",\"\\\"maybe\\\"\\n\"]",
+	"{ \"blue\" : -914 , \"green\" : null, \"red\" : 1 }",
+	"[0.5, -1e10, 2E-3, 1.7976931348623157e308]",
+};
+
+int main(int argc, char const *argv[])
+{
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::ifstream file{ argv[i], std::ios::binary };
+			std::stringstream ss;
+			ss << file.rdbuf();
+			const std::string input = ss.str();
+			LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(input.data()), input.size());
+		}
+
+		return 0;
+	}
+
+	std::mt19937 rng{ 0xf022 };
+	const char alphabet[] = "{}[]\",:\\ \t\n0123456789-+.eEtruefalsnxyu";
+
+	for (const char* seed : seeds)
+	{
+		for (int i = 0; i < 20'000; ++i)
+		{
+			std::string input = seed;
+
+			for (int n = rng() % 4 + 1; n > 0; --n)
+			{
+				const std::size_t pos = rng() % (input.size() + 1);
+
+				switch (rng() % 4)
+				{
+				case 0: input.insert(pos, 1, alphabet[rng() % (sizeof(alphabet) - 1)]); break;
+				case 1: if (pos < input.size()) input.erase(pos, 1); break;
+				case 2: if (pos < input.size()) input[pos] = static_cast<char>(rng()); break;
+				case 3: input.resize(pos); break;
+				}
+			}
+
+			LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(input.data()), input.size());
+		}
+	}
+
+	std::cout << "no failures.";
+}
+
+#endif // JSON_LIBFUZZER
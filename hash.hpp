@@ -0,0 +1,316 @@
+#ifndef __JSON_HASH_HPP
+#define __JSON_HASH_HPP
+
+// Hashes a value the way the descriptor sees it, without stringifying it: values of the same type
+// that would stringify identically hash identically. The mixing is wyhash's, so it is fast and
+// stable across runs and platforms with the same endianness, but not cryptographic.
+
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include "json.hpp"
+#include "reflection.hpp"
+#include "tape.hpp"
+
+namespace json
+{
+
+namespace detail
+{
+constexpr std::uint64_t wy_secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+inline void wy_multiply(std::uint64_t& a, std::uint64_t& b)
+{
+#ifdef __SIZEOF_INT128__
+	const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+	a = static_cast<std::uint64_t>(product);
+	b = static_cast<std::uint64_t>(product >> 64);
+#else
+	const std::uint64_t a_high = a >> 32, a_low = static_cast<std::uint32_t>(a);
+	const std::uint64_t b_high = b >> 32, b_low = static_cast<std::uint32_t>(b);
+	const std::uint64_t high = a_high * b_high, middle0 = a_high * b_low, middle1 = a_low * b_high, low = a_low * b_low;
+	const std::uint64_t carry = (static_cast<std::uint32_t>(middle0) + static_cast<std::uint64_t>(static_cast<std::uint32_t>(middle1)) + (low >> 32)) >> 32;
+	a = low + (middle0 << 32) + (middle1 << 32);
+	b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+}
+
+inline std::uint64_t wy_mix(std::uint64_t a, std::uint64_t b)
+{
+	wy_multiply(a, b);
+	return a ^ b;
+}
+
+inline std::uint64_t wy_read8(const unsigned char* p)
+{
+	std::uint64_t v;
+	std::memcpy(&v, p, 8);
+	return v;
+}
+
+inline std::uint64_t wy_read4(const unsigned char* p)
+{
+	std::uint32_t v;
+	std::memcpy(&v, p, 4);
+	return v;
+}
+
+inline std::uint64_t wyhash(const void* const data, const std::size_t size, std::uint64_t seed)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	std::uint64_t a, b;
+
+	seed ^= wy_mix(seed ^ wy_secret[0], wy_secret[1]);
+
+	if (size <= 16)
+	{
+		if (size >= 4)
+		{
+			a = (wy_read4(p) << 32) | wy_read4(p + ((size >> 3) << 2));
+			b = (wy_read4(p + size - 4) << 32) | wy_read4(p + size - 4 - ((size >> 3) << 2));
+		}
+		else if (size > 0)
+		{
+			a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+			b = 0;
+		}
+		else
+		{
+			a = b = 0;
+		}
+	}
+	else
+	{
+		std::size_t i = size;
+
+		if (i > 48)
+		{
+			std::uint64_t see1 = seed, see2 = seed;
+
+			do
+			{
+				seed = wy_mix(wy_read8(p) ^ wy_secret[1], wy_read8(p + 8) ^ seed);
+				see1 = wy_mix(wy_read8(p + 16) ^ wy_secret[2], wy_read8(p + 24) ^ see1);
+				see2 = wy_mix(wy_read8(p + 32) ^ wy_secret[3], wy_read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+
+			seed ^= see1 ^ see2;
+		}
+
+		while (i > 16)
+		{
+			seed = wy_mix(wy_read8(p) ^ wy_secret[1], wy_read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+
+		a = wy_read8(p + i - 16);
+		b = wy_read8(p + i - 8);
+	}
+
+	a ^= wy_secret[1];
+	b ^= seed;
+	wy_multiply(a, b);
+
+	return wy_mix(a ^ wy_secret[0] ^ size, b ^ wy_secret[1]);
+}
+}
+
+struct hasher
+{
+public:
+	std::uint64_t operator()(const auto& value, const auto& descriptor, const std::uint64_t seed = 0)
+	{
+		state = seed;
+		hash(value, descriptor);
+		return state;
+	}
+
+private:
+	// tags for the values without content of their own
+	static constexpr std::uint64_t null_tag = 0x6c6c756e;
+	static constexpr std::uint64_t true_tag = 0x65757274;
+	static constexpr std::uint64_t false_tag = 0x65736c6166;
+
+	std::uint64_t state{};
+
+	void mix(const std::uint64_t value)
+	{
+		state = detail::wy_mix(state ^ detail::wy_secret[0], value ^ detail::wy_secret[1]);
+	}
+
+	void mix(const char* const data, const std::size_t size)
+	{
+		state = detail::wyhash(data, size, state);
+	}
+
+	template <typename T, Descriptor TDesc>
+	void hash(const std::optional<T>& value, const TDesc& descriptor)
+	{
+		if (value)
+			hash(*value, descriptor);
+		else
+			mix(null_tag);
+	}
+
+	template <Boolean T> requires (Mandatory<T>)
+	void hash(const T& value, const boolean_t&)
+	{
+		mix(value ? true_tag : false_tag);
+	}
+
+	// integers print the same exactly when they're equal, floating point numbers are hashed as
+	// they're printed
+	template <Number T>
+	void hash(const T& value, const number_t&)
+	{
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			char digits[64];
+			const auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+			mix(digits, result.ptr - digits);
+		}
+		else
+		{
+			mix(static_cast<std::uint64_t>(value));
+		}
+	}
+
+	// numbers kept as text hash as they're written
+	template <NumberText T>
+	void hash(const T& value, const number_t&)
+	{
+		if constexpr (std::is_bounded_array_v<T>)
+			mix(value, std::find(value, value + std::extent_v<T>, '\0') - value);
+		else
+			mix(std::ranges::data(value), std::ranges::size(value));
+	}
+
+	// the same decimal is always held in the same integer
+	template <std::integral T, int Scale, rounding Rounding>
+	void hash(const T& value, const decimal_t<Scale, Rounding>&)
+	{
+		mix(static_cast<std::uint64_t>(value));
+	}
+
+	template <String T>
+	void hash(const T& value, const string_t&)
+	{
+		if constexpr (std::is_same_v<T, char>)
+		{
+			mix(&value, 1);
+		}
+		else if constexpr (std::is_same_v<T, const char*>)
+		{
+			mix(value, std::strlen(value));
+		}
+		else if constexpr (std::is_bounded_array_v<T>)
+		{
+			mix(value, std::find(value, value + std::extent_v<T>, '\0') - value);
+		}
+		else if constexpr (std::ranges::contiguous_range<T>)
+		{
+			mix(std::ranges::data(value), std::ranges::size(value));
+		}
+		else
+		{
+			const std::string copy(std::ranges::begin(value), std::ranges::end(value));
+			mix(copy.data(), copy.size());
+		}
+	}
+
+	template <Array T, typename TValue>
+	void hash(const T& values, const array<TValue>& descriptor)
+	{
+		std::uint64_t count{};
+
+		for (const auto& value : values)
+		{
+			hash(value, descriptor.value_descriptor);
+			count++;
+		}
+
+		mix(count);
+	}
+
+	template <Descriptor TValue>
+	void hash(const auto& values, const object<TValue>& descriptor)
+	{
+		std::uint64_t count{};
+
+		for (const auto& [key, value] : values)
+		{
+			hash(key, string);
+			hash(value, descriptor.value_descriptor);
+			count++;
+		}
+
+		mix(count);
+	}
+
+	// values on a tape hash like the ones they'd be parsed into, numbers as they're written
+	void hash(const tape& value, const any_t&)
+	{
+		hash(value.root());
+	}
+
+	void hash(const tape::value& value)
+	{
+		switch (value.type())
+		{
+		case tape::kind::null:
+			mix(null_tag);
+			break;
+		case tape::kind::boolean:
+			mix(value.as_bool() ? true_tag : false_tag);
+			break;
+		case tape::kind::number:
+		case tape::kind::string: {
+			const std::string_view text = value.as_string();
+			mix(text.data(), text.size());
+			break;
+		}
+		case tape::kind::array:
+			for (const tape::value element : value)
+				hash(element);
+
+			mix(value.size());
+			break;
+		case tape::kind::object:
+			for (auto member = value.begin(); member != value.end(); ++member)
+			{
+				const std::string_view key = member.key();
+				mix(key.data(), key.size());
+				hash(*member);
+			}
+
+			mix(value.size());
+			break;
+		}
+	}
+
+	// field names come with the type, so only the values are hashed
+	template <typename T, Members TMembers>
+	void hash(const T& value, const TMembers& members)
+	{
+		for_each_member(value, members, [this](const auto& member, const auto& member_value) {
+			hash(member_value, member.descriptor);
+		});
+	}
+};
+
+// the hash of value as described by descriptor, see hasher
+inline std::uint64_t hash(const auto& value, const auto& descriptor, const std::uint64_t seed = 0)
+{
+	return hasher{}(value, descriptor, seed);
+}
+
+} // json
+
+#endif // __JSON_HASH_HPP
@@ -2,8 +2,10 @@
 #define __JSON_HPP
 
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <optional>
+#include <cstdint>
 
 namespace json
 {
@@ -14,6 +16,25 @@ struct number_t {} number;
 
 struct string_t {} string;
 
+// any json value, parsed into a json::tape
+struct any_t {} any;
+
+// what a decimal does with digits past its scale
+enum class rounding
+{
+	exact, // fails to parse unless they're all zeros
+	truncate, // drops them, rounding towards zero
+	half_even, // rounds to the nearest, ties to even
+};
+
+// a number held in an integer as a count of 10^-Scale, so decimal<2> holds 12.34 as 1234. Numbers
+// that don't fit the integer fail to parse.
+template <int Scale, rounding Rounding = rounding::exact> requires (Scale >= 0 && Scale <= 18)
+struct decimal_t {};
+
+template <int Scale, rounding Rounding = rounding::exact>
+constexpr decimal_t<Scale, Rounding> decimal{};
+
 template <typename TDesc>
 struct array
 {
@@ -26,6 +47,21 @@ struct object
 	TDesc value_descriptor;
 };
 
+namespace detail
+{
+template <typename T>
+constexpr bool is_array_descriptor_v = false;
+
+template <typename TValueDesc>
+constexpr bool is_array_descriptor_v<array<TValueDesc>> = true;
+
+template <typename T>
+constexpr bool is_object_descriptor_v = false;
+
+template <typename TValueDesc>
+constexpr bool is_object_descriptor_v<object<TValueDesc>> = true;
+}
+
 // =====
 
 template <typename T>
@@ -79,6 +115,10 @@ concept Number = std::is_arithmetic_v<T>;
 template <typename T>
 concept String = std::is_same_v<T, char> || std::is_same_v<T, const char*> || (std::is_bounded_array_v<T> || BuildableRange<T>) && std::is_same_v<underlying_value_type_t<T>, char>;
 
+// a number kept as it's written, see json::number
+template <typename T>
+concept NumberText = std::is_same_v<T, std::string_view> || (std::is_bounded_array_v<T> || (BuildableRange<T> && std::ranges::contiguous_range<T>)) && std::is_same_v<underlying_value_type_t<T>, char>;
+
 template <typename T>
 concept Array = std::is_bounded_array_v<T> || BuildableRange<T>;
 
@@ -87,6 +127,57 @@ concept Object = (std::is_bounded_array_v<T> || BuildableRange<T>) && is_pair_v<
 
 // =====
 
+namespace detail
+{
+// 10^n for every n that fits 64 bits
+constexpr std::uint64_t powers_of_ten[20] = {
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+	10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull,
+	10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+};
+
+// returns the end of the number token starting at it, or it when there isn't one
+constexpr const char* scan_number(const char* it, const char* const end)
+{
+	const char* const begin = it;
+
+	const auto skip_digits = [&it, end]() {
+		const char* const digits_begin = it;
+		while (it != end && *it >= '0' && *it <= '9')
+			++it;
+		return it != digits_begin;
+	};
+
+	if (it != end && *it == '-')
+		++it;
+
+	if (it != end && *it == '0')
+		++it;
+	else if (!skip_digits())
+		return begin;
+
+	if (it != end && *it == '.')
+	{
+		const char* const dot = it;
+		if (++it; !skip_digits())
+			return dot;
+	}
+
+	if (it != end && (*it == 'e' || *it == 'E'))
+	{
+		const char* const e = it;
+		if (++it; it != end && (*it == '+' || *it == '-'))
+			++it;
+		if (!skip_digits())
+			return e;
+	}
+
+	return it;
+}
+}
+
+// =====
+
 namespace literals
 {
 constexpr std::string null{ "null" };
@@ -105,6 +196,10 @@ concept Descriptor = is_valid_descriptor_v<T>;
 template <> constexpr bool is_valid_descriptor_v<boolean_t> = true;
 template <> constexpr bool is_valid_descriptor_v<number_t> = true;
 template <> constexpr bool is_valid_descriptor_v<string_t> = true;
+template <> constexpr bool is_valid_descriptor_v<any_t> = true;
+
+template <int Scale, rounding Rounding>
+constexpr bool is_valid_descriptor_v<decimal_t<Scale, Rounding>> = true;
 
 template <typename TValue>
 constexpr bool is_valid_descriptor_v<array<TValue>> = is_valid_descriptor_v<TValue>;
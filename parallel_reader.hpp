@@ -0,0 +1,247 @@
+#ifndef __JSON_PARALLEL_READER_HPP
+#define __JSON_PARALLEL_READER_HPP
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <optional>
+#include <algorithm>
+
+#include "parser.hpp"
+#include "compression.hpp"
+
+namespace json
+{
+
+// A fixed set of worker threads taking jobs off a queue.
+class thread_pool
+{
+public:
+	explicit thread_pool(unsigned threads = 0)
+	{
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		for (unsigned i = 0; i < threads; i++)
+			workers.emplace_back([this]() { run(); });
+	}
+
+	// finishes the queued jobs first
+	~thread_pool()
+	{
+		{
+			std::lock_guard lock{ mutex };
+			stopping = true;
+		}
+
+		cv.notify_all();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	std::size_t size() const { return workers.size(); }
+
+	template <typename TFunction>
+	auto submit(TFunction&& function)
+	{
+		using result_type = std::invoke_result_t<TFunction>;
+
+		auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<TFunction>(function));
+		std::future<result_type> result = task->get_future();
+
+		{
+			std::lock_guard lock{ mutex };
+			jobs.emplace_back([task]() { (*task)(); });
+		}
+
+		cv.notify_one();
+		return result;
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<std::function<void()>> jobs;
+	std::vector<std::thread> workers;
+	bool stopping{};
+
+	void run()
+	{
+		std::unique_lock lock{ mutex };
+
+		for (;;)
+		{
+			cv.wait(lock, [this]() { return !jobs.empty() || stopping; });
+
+			if (jobs.empty())
+				return;
+
+			std::function<void()> job = std::move(jobs.front());
+			jobs.pop_front();
+
+			lock.unlock();
+			job();
+			lock.lock();
+		}
+	}
+};
+
+#ifdef JSON_WITH_ZSTD
+// Splits a zstd stream into its frames without decompressing them.
+class zstd_frame_splitter
+{
+public:
+	static constexpr std::size_t default_chunk_size = 1 << 20;
+
+	explicit zstd_frame_splitter(std::unique_ptr<source> compressed, const std::size_t chunk_size = default_chunk_size)
+		: compressed{ std::move(compressed) }, chunk_size{ chunk_size }
+	{
+	}
+
+	// the next whole frame, or nothing at the end of the input or if it isn't zstd
+	std::optional<std::string> next()
+	{
+		for (;;)
+		{
+			const std::size_t size = ZSTD_findFrameCompressedSize(buffer.data() + begin, buffer.size() - begin);
+
+			if (!ZSTD_isError(size))
+			{
+				std::string frame = buffer.substr(begin, size);
+				begin += size;
+				return frame;
+			}
+
+			if (at_eof || ZSTD_getErrorCode(size) != ZSTD_error_srcSize_wrong)
+			{
+				truncated = begin != buffer.size();
+				return std::nullopt;
+			}
+
+			buffer.erase(0, begin);
+			begin = 0;
+
+			const std::size_t end = buffer.size();
+			buffer.resize(end + chunk_size);
+			const std::size_t n = compressed->read(buffer.data() + end, chunk_size);
+			buffer.resize(end + n);
+			at_eof = n == 0;
+		}
+	}
+
+	// true if the input ended part way through a frame, or isn't zstd
+	bool failed() const { return truncated; }
+
+private:
+	std::unique_ptr<source> compressed;
+	std::size_t chunk_size;
+	std::string buffer;
+	std::size_t begin{};
+	bool at_eof{};
+	bool truncated{};
+};
+
+// Parses newline delimited (or just whitespace separated) records from zstd frames on a thread
+// pool, and hands them to the callback on the calling thread in order. Every frame has to hold
+// whole records, which is what zstd_sink::end_frame between records gives. Returns false if a
+// record doesn't parse or the input is cut short, after the records before it were handed over.
+template <typename T>
+bool parallel_for_each(std::unique_ptr<source> compressed, const auto& descriptor, auto&& callback, const unsigned threads = 0)
+{
+	struct batch
+	{
+		std::vector<T> records;
+		bool success;
+	};
+
+	// a decompression context and reader buffer, kept for the next frame once one is done with them,
+	// so there are never more than there are threads
+	struct worker
+	{
+		zstd_source* source;
+		buffered_reader reader;
+	};
+
+	std::mutex idle_mutex;
+	std::vector<std::unique_ptr<worker>> idle;
+
+	const auto take_worker = [&]() {
+		{
+			std::lock_guard lock{ idle_mutex };
+
+			if (!idle.empty())
+			{
+				std::unique_ptr<worker> state = std::move(idle.back());
+				idle.pop_back();
+				return state;
+			}
+		}
+
+		auto decompressed = std::make_unique<zstd_source>(nullptr);
+		zstd_source* const source = decompressed.get();
+		return std::unique_ptr<worker>{ new worker{ source, buffered_reader{ std::move(decompressed) } } };
+	};
+
+	thread_pool pool{ threads };
+	zstd_frame_splitter frames{ std::move(compressed) };
+	std::deque<std::future<batch>> pending;
+	bool success = true;
+
+	// hands over the oldest frame's records
+	const auto deliver = [&]() {
+		batch result = pending.front().get();
+		pending.pop_front();
+
+		if (!success)
+			return;
+
+		for (T& record : result.records)
+			callback(std::move(record));
+
+		success = result.success;
+	};
+
+	while (success)
+	{
+		std::optional<std::string> frame = frames.next();
+		if (!frame)
+			break;
+
+		pending.push_back(pool.submit([frame = std::move(*frame), &descriptor, &take_worker, &idle_mutex, &idle]() {
+			std::unique_ptr<worker> state = take_worker();
+			state->source->reset(std::make_unique<memory_source>(frame));
+			state->reader.reset();
+
+			parser parse{};
+			batch result{};
+
+			result.success = parse.for_each<T>(state->reader, descriptor, [&](T&& record) { result.records.push_back(std::move(record)); });
+			result.success &= !state->source->failed();
+
+			std::lock_guard lock{ idle_mutex };
+			idle.push_back(std::move(state));
+			return result;
+		}));
+
+		// enough frames in flight to keep every thread busy without holding the whole input
+		if (pending.size() > 2 * pool.size())
+			deliver();
+	}
+
+	while (!pending.empty())
+		deliver();
+
+	return success && !frames.failed();
+}
+#endif // JSON_WITH_ZSTD
+
+} // json
+
+#endif // __JSON_PARALLEL_READER_HPP
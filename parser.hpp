@@ -4,22 +4,27 @@
 #include <type_traits>
 #include <charconv>
 #include <cctype>
-#include <regex>
 #include <array>
 #include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <bitset>
+#include <limits>
+#include <utility>
 
 #include "json.hpp"
+#include "reflection.hpp"
+#include "simd.hpp"
+#include "reader.hpp"
+#include "tape.hpp"
 
 namespace json
 {
 
 namespace
 {
-const std::regex null_re{ "^null" };
-const std::regex bool_re{ "^true|false" };
-const std::regex number_re{ "^[+-]?(?:0|[1-9]\\d*)(?:\\.\\d+)?(?:[eE][+-]?\\d+)?" };
-//const std::regex string_re{ "^\"(?:[^\\\\]|\\\\(?:\"|\\\\|\\/|b|f|n|r|t|u\\d{1,4}))*\"" };
-
 auto get_inserter_iterator(BackInsertable auto& container) { return std::back_inserter(container); }
 
 template <typename T> requires (Insertable<T> && !BackInsertable<T>)
@@ -44,6 +49,80 @@ constexpr std::size_t string_extent_v = extent_v<T>;
 
 template <>
 constexpr std::size_t string_extent_v<char> = 1;
+
+template <typename T>
+concept Appendable = requires(T& t, const char* s, std::size_t n) { { t.append(s, n) }; };
+
+template <typename T>
+concept Clearable = requires(T& t) { { t.clear() }; };
+
+template <typename T>
+concept Resizable = requires(T& t, std::size_t n) { { t.resize(n) }; { t[n] } -> std::same_as<std::ranges::range_value_t<T>&>; };
+
+template <typename T>
+concept Keyed = requires(T& t, const T::key_type& key) { { t.find(key) }; { t.erase(key) }; };
+
+template <typename T>
+concept NodeBased = requires(T& t, const T::key_type& key) { { t.insert(t.extract(key)) }; };
+
+// assigns arrays element by element
+template <typename T>
+void assign(T& to, const T& from)
+{
+	if constexpr (std::is_array_v<T>)
+	{
+		for (std::size_t i = 0; i < std::extent_v<T>; i++)
+			assign(to[i], from[i]);
+	}
+	else
+	{
+		to = from;
+	}
+}
+
+// does parsing a T described by TDesc point string_views into the input, which then has to outlive them
+template <typename T, typename TDesc>
+constexpr bool points_into_input()
+{
+	if constexpr (is_optional_v<T>)
+	{
+		return points_into_input<typename T::value_type, TDesc>();
+	}
+	else if constexpr (std::is_same_v<TDesc, number_t>)
+	{
+		return std::is_same_v<T, std::string_view>;
+	}
+	else if constexpr (detail::is_array_descriptor_v<TDesc>)
+	{
+		return points_into_input<underlying_value_type_t<T>, decltype(TDesc::value_descriptor)>();
+	}
+	else if constexpr (detail::is_object_descriptor_v<TDesc>)
+	{
+		return points_into_input<typename underlying_value_type_t<T>::second_type, decltype(TDesc::value_descriptor)>();
+	}
+	else if constexpr (Members<TDesc>)
+	{
+		return []<typename... TMembers>(std::type_identity<std::tuple<TMembers...>>) {
+			return (points_into_input<member_value_t<TMembers>, member_descriptor_t<TMembers>>() || ...);
+		}(std::type_identity<std::remove_const_t<TDesc>>{});
+	}
+	else
+	{
+		return false;
+	}
+}
+
+// values that don't point into the text they were parsed from, so it can go once they're parsed
+template <typename T, typename TDesc>
+concept SelfContained = !points_into_input<std::remove_cvref_t<T>, std::remove_cvref_t<TDesc>>();
+
+// a new T, built once, to reset members from
+template <typename T>
+const T& default_value()
+{
+	static const T value{};
+	return value;
+}
 }
 
 struct parser
@@ -51,30 +130,174 @@ struct parser
 public:
 	bool terminate_char_arrays = true;
 
-	bool operator()(const std::string& line, auto& value, const auto& descriptor)
+	// parses into the value as it is instead of a default constructed one: elements already in arrays
+	// and strings are overwritten, keeping their capacity, maps are updated by key and members missing
+	// from an object are reset. Parsing the same shape again allocates nothing.
+	bool update = false;
+
+	bool operator()(const std::string_view line, auto& value, const auto& descriptor)
+	{
+		return parse(line.data(), line.data() + line.size(), value, descriptor).success;
+	}
+
+	// parses the next value from the reader, check reader.eof() to tell the end of the input from a failure
+	bool operator()(buffered_reader& reader, auto& value, const auto& descriptor)
+	{
+		static_assert(SelfContained<decltype(value), decltype(descriptor)>, "a stream's buffer is reused, so numbers from it can't be kept as std::string_view: use a std::string or a char array");
+
+		const std::optional<std::string_view> text = reader.next();
+		return text && (*this)(*text, value, descriptor);
+	}
+
+	// parses every value from the reader into a T and hands it to the callback, returns false if one
+	// doesn't parse or the input stops part way through one
+	template <typename T>
+	bool for_each(buffered_reader& reader, const auto& descriptor, auto&& callback)
+	{
+		static_assert(SelfContained<T, decltype(descriptor)>, "a stream's buffer is reused, so numbers from it can't be kept as std::string_view: use a std::string or a char array");
+
+		while (const std::optional<std::string_view> text = reader.next())
+		{
+			T value{};
+
+			if (!(*this)(*text, value, descriptor))
+				return false;
+
+			callback(std::move(value));
+		}
+
+		return !reader.failed();
+	}
+
+	// parses the next value in the stream, taking nothing past its end so the next call gets the value
+	// after it. A buffered_reader is faster for many values. eof() is set once the stream is used up.
+	bool operator()(std::istream& is, auto& value, const auto& descriptor)
 	{
-		return parse(line.cbegin(), line.cend(), value, descriptor).success;
+		static_assert(SelfContained<decltype(value), decltype(descriptor)>, "a stream's buffer is reused, so numbers from it can't be kept as std::string_view: use a std::string or a char array");
+
+		constexpr int eof = std::char_traits<char>::eof();
+		std::streambuf& buffer = *is.rdbuf();
+
+		const bool read = read_value(
+			[&]() { const int c = buffer.sgetc(); return c == eof ? -1 : c; },
+			[&]() { buffer.sbumpc(); });
+
+		if (buffer.sgetc() == eof)
+			is.setstate(std::ios::eofbit);
+
+		return read && (*this)(std::string_view{ value_text }, value, descriptor);
 	}
 
+	// applies a json merge patch (RFC 7396) to the value: members in the patch are parsed over the
+	// ones in the value as in update mode, except that objects are merged into rather than replaced,
+	// members set to null are reset (and keys erased from maps) and members not in the patch are left
+	// alone. Arrays are replaced.
+	bool merge_patch(const std::string_view patch, auto& value, const auto& descriptor)
+	{
+		const bool was_updating = std::exchange(update, true);
+		merging = true;
+
+		const bool success = (*this)(patch, value, descriptor);
+
+		merging = false;
+		update = was_updating;
+		return success;
+	}
+
+#ifdef JSON_HAS_POSIX_IO
+	// parses the next value read from the file descriptor, leaving what follows it to be read. Files are
+	// read ahead and rewound, pipes and sockets read a byte at a time, where a number or literal at the
+	// top level takes the character after it along.
+	bool operator()(const int fd, auto& value, const auto& descriptor)
+	{
+		static_assert(SelfContained<decltype(value), decltype(descriptor)>, "a stream's buffer is reused, so numbers from it can't be kept as std::string_view: use a std::string or a char array");
+
+		if (::lseek(fd, 0, SEEK_CUR) != -1)
+		{
+			buffered_reader reader{ fd, single_value_buffer_size };
+			const bool success = (*this)(reader, value, descriptor);
+			::lseek(fd, -static_cast<off_t>(reader.buffered()), SEEK_CUR);
+			return success;
+		}
+
+		fd_source source{ fd };
+		int next = -2;
+
+		const bool read = read_value(
+			[&]() {
+				if (char c; next == -2)
+					next = source.read(&c, 1) == 1 ? static_cast<unsigned char>(c) : -1;
+				return next;
+			},
+			[&]() { next = -2; });
+
+		return read && (*this)(std::string_view{ value_text }, value, descriptor);
+	}
+#endif
+
 private:
+	friend struct patcher;
+
+	using iterator = const char*;
+
+	static constexpr std::size_t single_value_buffer_size = 1 << 16;
+
+	// the text of the last value read from a stream, kept for its capacity
+	std::string value_text;
+
+	// the entries of the maps being updated that the input mentioned, kept for its capacity
+	std::vector<const void*> seen_entries;
+
+	// reads the text of the next value into value_text a character at a time, so nothing past its end
+	// is taken from the input. peek() returns the next character, or -1 at the end of the input, and
+	// bump() moves past it.
+	bool read_value(auto&& peek, auto&& bump)
+	{
+		value_text.clear();
+		value_scanner scanner;
+
+		while (peek() != -1 && value_scanner::is_whitespace(static_cast<char>(peek())))
+			bump();
+
+		for (int c; (c = peek()) != -1; bump())
+		{
+			value_text.push_back(static_cast<char>(c));
+			const char* const last = value_text.data() + value_text.size() - 1;
+
+			// a number or literal ends before the character that follows it
+			if (const std::size_t n = scanner.scan(last, last + 1, false); n != value_scanner::incomplete)
+			{
+				if (n == 0)
+					value_text.pop_back();
+				else
+					bump();
+
+				return true;
+			}
+		}
+
+		const char* const end = value_text.data() + value_text.size();
+		return scanner.scan(end, end, true) != value_scanner::incomplete;
+	}
+
+	bool merging{};
+
 	struct parse_result
 	{
-		std::string::const_iterator it;
+		iterator it;
 		bool success;
 	};
 
-	using iterator = std::string::const_iterator;
-
 	template <typename T, typename TDesc>
 	parse_result parse(iterator begin, const iterator end, std::optional<T>& value, const TDesc& descriptor)
 	{
-		if (std::smatch match; std::regex_search(begin, end, null_re))
+		if (match_literal(begin, end, literals::null))
 		{
 			value.reset();
-			return parse_result{ match[0].second, true };
+			return parse_result{ begin + literals::null.size(), true };
 		}
 		
-		return parse(begin, end, value.emplace(), descriptor);
+		return parse(begin, end, update && value ? *value : value.emplace(), descriptor);
 	}
 
 	parse_result parse(const iterator begin, const iterator end, Mandatory auto& value, const boolean_t&)
@@ -87,15 +310,41 @@ private:
 		return parse_number(begin, end, value);
 	}
 
+	template <std::integral T, int Scale, rounding Rounding> requires (!std::is_same_v<T, bool>)
+	parse_result parse(const iterator begin, const iterator end, T& value, const decimal_t<Scale, Rounding>&)
+	{
+		return parse_decimal<Scale, Rounding>(begin, end, value);
+	}
+
 	parse_result parse(const iterator begin, const iterator end, Mandatory auto& value, const string_t&)
 	{
 		return parse_string(begin, end, value);
 	}
 
+	parse_result parse(const iterator begin, const iterator end, tape& value, const any_t&)
+	{
+		value.clear();
+
+		// strings are appended to the tape's text, which update mode would clear for each one
+		const bool was_updating = std::exchange(update, false);
+		const parse_result result = parse_any(begin, end, value);
+		update = was_updating;
+
+		// a failure can leave containers open, which can't be walked
+		if (!result.success)
+			value.clear();
+
+		return result;
+	}
+
+	// a merge patch replaces arrays as a whole
 	template <typename TValueDesc>
 	parse_result parse(const iterator begin, const iterator end, Mandatory auto& value, const array<TValueDesc>& descriptor)
 	{
-		return parse_array(begin, end, value, descriptor.value_descriptor);
+		const bool was_merging = std::exchange(merging, false);
+		const auto result = parse_array(begin, end, value, descriptor.value_descriptor);
+		merging = was_merging;
+		return result;
 	}
 
 	template <typename TValueDesc>
@@ -113,45 +362,259 @@ private:
 	template <typename T, typename TElements> requires (is_element_list_v<TElements>)
 	parse_result parse(const iterator begin, const iterator end, T& value, const TElements& fields)
 	{
-		return parse_elements(begin, end, value, fields);
+		const bool was_merging = std::exchange(merging, false);
+		const auto result = parse_elements(begin, end, value, fields);
+		merging = was_merging;
+		return result;
+	}
+
+	static bool match_literal(const iterator begin, const iterator end, const std::string& literal)
+	{
+		return static_cast<std::size_t>(end - begin) >= literal.size() && std::equal(literal.begin(), literal.end(), begin);
 	}
 
 	parse_result parse_boolean(const iterator begin, const iterator end, auto& value)
 	{
-		if (std::smatch match; std::regex_search(begin, end, match, bool_re))
+		if (match_literal(begin, end, literals::true_))
 		{
-			value = match.str() == literals::true_;
-			return parse_result{ match[0].second, true };
+			value = true;
+			return parse_result{ begin + literals::true_.size(), true };
+		}
+
+		if (match_literal(begin, end, literals::false_))
+		{
+			value = false;
+			return parse_result{ begin + literals::false_.size(), true };
 		}
 
 		return parse_result{ begin, false };
 	}
 
+	// checked as it's scanned, then copied or pointed to as it is
+	template <NumberText T>
+	parse_result parse_number(const iterator begin, const iterator end, T& value)
+	{
+		const iterator number_end = detail::scan_number(begin, end);
+		const std::size_t size = static_cast<std::size_t>(number_end - begin);
+
+		if (number_end == begin)
+			return parse_result{ begin, false };
+
+		if constexpr (std::is_same_v<T, std::string_view>)
+		{
+			value = std::string_view{ begin, size };
+		}
+		else if constexpr (std::is_bounded_array_v<T>)
+		{
+			// a number isn't cut off like a string would be
+			if (size + (terminate_char_arrays ? 1 : 0) > std::extent_v<T>)
+				return parse_result{ begin, false };
+
+			std::copy(begin, number_end, value);
+
+			if (size < std::extent_v<T>)
+				value[size] = '\0';
+		}
+		else if constexpr (requires { value.assign(begin, number_end); })
+		{
+			value.assign(begin, number_end);
+		}
+		else
+		{
+			value = T(begin, number_end);
+		}
+
+		return parse_result{ number_end, true };
+	}
+
 	parse_result parse_number(const iterator begin, const iterator end, auto& value)
 	{
-		if (std::smatch match; std::regex_search(begin, end, match, number_re))
+		if (const iterator number_end = detail::scan_number(begin, end); number_end != begin)
 		{
-			const char* pBegin = &*begin;
 			return parse_result{
-				match[0].second,
-				std::from_chars(pBegin, pBegin + (match[0].second - begin), value).ec == std::errc{}
+				number_end,
+				std::from_chars(begin, number_end, value).ec == std::errc{}
 			};
 		}
 
 		return parse_result{ begin, false };
 	}
 
+	// keeps as many significant digits as fit 64 bits in an integer as they're read, along with where
+	// its last digit sits against the scale, and only then scales and rounds
+	template <int Scale, rounding Rounding, typename T>
+	static parse_result parse_decimal(iterator it, const iterator end, T& value)
+	{
+		constexpr int max_digits = 19;
+		constexpr std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+
+		const auto is_digit = [&it, end]() { return it != end && *it >= '0' && *it <= '9'; };
+
+		const bool negative = it != end && *it == '-';
+		if (negative)
+			++it;
+
+		if (!is_digit())
+			return parse_result{ it, false };
+
+		std::uint64_t mantissa{};
+		int shift = Scale;
+		int first_dropped{};
+		bool dropped{};
+		bool rest_dropped{};
+
+		const auto accumulate = [&](const bool fraction) {
+			const int digit = *it++ - '0';
+
+			if (!dropped && (mantissa < max / 10 || (mantissa == max / 10 && digit <= static_cast<int>(max % 10))))
+			{
+				mantissa = mantissa * 10 + digit;
+
+				if (fraction)
+					shift--;
+			}
+			else
+			{
+				if (!fraction)
+					shift++;
+
+				if (!dropped)
+					first_dropped = digit;
+				else
+					rest_dropped |= digit != 0;
+
+				dropped = true;
+			}
+		};
+
+		if (*it == '0')
+			++it;
+		else while (is_digit())
+			accumulate(false);
+
+		if (it != end && *it == '.')
+		{
+			if (++it; !is_digit())
+				return parse_result{ it, false };
+
+			while (is_digit())
+				accumulate(true);
+		}
+
+		if (it != end && (*it == 'e' || *it == 'E'))
+		{
+			bool negative_exponent{};
+
+			if (++it; it != end && (*it == '+' || *it == '-'))
+				negative_exponent = *it++ == '-';
+
+			if (!is_digit())
+				return parse_result{ it, false };
+
+			int exponent{};
+
+			for (; is_digit(); ++it)
+			{
+				if (exponent < 100000)
+					exponent = exponent * 10 + (*it - '0');
+			}
+
+			shift += negative_exponent ? -exponent : exponent;
+		}
+
+		// how what's cut off compares to half a unit
+		enum { none, below, half, above } rest = none;
+		std::uint64_t magnitude = mantissa;
+
+		if (mantissa == 0 && !dropped)
+		{
+			magnitude = 0;
+		}
+		else if (shift >= 0)
+		{
+			if (shift > max_digits || (dropped && shift != 0) || mantissa > max / detail::powers_of_ten[shift])
+				return parse_result{ it, false };
+
+			magnitude = mantissa * detail::powers_of_ten[shift];
+
+			if (dropped && (first_dropped != 0 || rest_dropped))
+				rest = first_dropped < 5 ? below : first_dropped > 5 || rest_dropped ? above : half;
+		}
+		else if (-shift > max_digits)
+		{
+			magnitude = 0;
+			rest = below;
+		}
+		else
+		{
+			const std::uint64_t unit = detail::powers_of_ten[-shift];
+			const std::uint64_t remainder = mantissa % unit;
+			const bool sticky = dropped && (first_dropped != 0 || rest_dropped);
+			magnitude = mantissa / unit;
+
+			if (remainder != 0 || sticky)
+				rest = remainder < unit - remainder ? below : remainder > unit - remainder || sticky ? above : half;
+		}
+
+		if constexpr (Rounding == rounding::exact)
+		{
+			if (rest != none)
+				return parse_result{ it, false };
+		}
+		else if constexpr (Rounding == rounding::half_even)
+		{
+			if (rest == above || (rest == half && magnitude % 2 != 0))
+				magnitude++;
+		}
+
+		if (negative)
+		{
+			if (magnitude == 0)
+				value = 0;
+			else if (std::is_unsigned_v<T> || magnitude - 1 > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))
+				return parse_result{ it, false };
+			else
+				value = static_cast<T>(-static_cast<std::int64_t>(magnitude - 1) - 1);
+		}
+		else
+		{
+			if (magnitude > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))
+				return parse_result{ it, false };
+
+			value = static_cast<T>(magnitude);
+		}
+
+		return parse_result{ it, true };
+	}
+
 	template <typename T>
 	parse_result parse_string(iterator it, const iterator end, T& value)
 	{
-		if (*it != '"' || ++it == end)
+		if (it == end || *it != '"' || ++it == end)
 			return parse_result{ it, false };
 
+		if constexpr (Clearable<T>)
+		{
+			if (update)
+				value.clear();
+		}
+
 		auto str_it = get_inserter_iterator(value);
 		const bool needs_terminating = std::is_bounded_array_v<T> && terminate_char_arrays;
 
 		for (std::size_t n{ needs_terminating }; it != end && *it != '"'; n++, ++it)
 		{
+			if constexpr (Appendable<T> && string_extent_v<T> == std::dynamic_extent)
+			{
+				if (*it != '\\')
+				{
+					const iterator run_end = simd::find_quote_or_backslash(it, end);
+					value.append(it, run_end - it);
+					it = run_end - 1;
+					continue;
+				}
+			}
+
 			int value{};
 
 			if (*it == '\\')
@@ -176,7 +639,7 @@ private:
 						++hex_it;
 					if (n != 4)
 						return parse_result{ it, false };
-					std::from_chars(&*it, &*it + 4, value, 16);
+					std::from_chars(it, it + 4, value, 16);
 					it += 3;
 					break;
 				}
@@ -218,7 +681,18 @@ private:
 	template <typename T>
 	parse_result parse_array(iterator it, const iterator end, T& value, const auto& value_type_descriptor)
 	{
-		if (*it != '[')
+		if constexpr (std::is_bounded_array_v<T> || Resizable<T>)
+		{
+			if (update)
+				return update_array(it, end, value, value_type_descriptor);
+		}
+		else if constexpr (Clearable<T>)
+		{
+			if (update)
+				value.clear();
+		}
+
+		if (it == end || *it != '[')
 			return parse_result{ it, false };
 
 		if (!skip_whitespace(++it, end))
@@ -252,6 +726,203 @@ private:
 		return parse_result{ it + 1, true };
 	}
 
+	// parses each element over the one already at its position, then drops or resets the ones past the end
+	template <typename T>
+	parse_result update_array(iterator it, const iterator end, T& value, const auto& value_type_descriptor)
+	{
+		if (it == end || *it != '[')
+			return parse_result{ it, false };
+
+		if (!skip_whitespace(++it, end))
+			return parse_result{ it, false };
+
+		std::size_t n{};
+
+		for (; it != end && *it != ']'; n++)
+		{
+			parse_result result;
+
+			if constexpr (std::is_bounded_array_v<T>)
+			{
+				if (n < extent_v<T>)
+				{
+					result = parse(it, end, value[n], value_type_descriptor);
+				}
+				else
+				{
+					underlying_value_type_t<T> element{};
+					result = parse(it, end, element, value_type_descriptor);
+				}
+			}
+			else
+			{
+				if (n == value.size())
+					value.resize(n + 1);
+
+				result = parse(it, end, value[n], value_type_descriptor);
+			}
+
+			if (!result.success)
+				return result;
+
+			if (!skip_whitespace(it = result.it, end))
+				return parse_result{ it, false };
+
+			if (*it == ',')
+				skip_whitespace(++it, end);
+		}
+
+		if (it == end)
+			return parse_result{ it, false };
+
+		if constexpr (std::is_bounded_array_v<T>)
+		{
+			for (; n < extent_v<T>; n++)
+				assign(value[n], underlying_value_type_t<T>{});
+		}
+		else
+		{
+			value.resize(n);
+		}
+
+		return parse_result{ it + 1, true };
+	}
+
+	// parses into the entries whose keys are still there so only new keys allocate, then drops the ones
+	// that are gone. Entries are marked by address, which a node based map keeps stable. On a failure
+	// nothing is dropped.
+	template <typename T>
+	parse_result update_object(iterator it, const iterator end, T& value, const auto& value_type_descriptor)
+	{
+		if (it == end || *it != '{')
+			return parse_result{ it, false };
+
+		if (!skip_whitespace(++it, end))
+			return parse_result{ it, false };
+
+		// nested maps share the list, each one only looks past where it started
+		const std::size_t first_seen = seen_entries.size();
+		const auto failure = [&](const iterator at) {
+			seen_entries.resize(first_seen);
+			return parse_result{ at, false };
+		};
+
+		std::remove_const_t<typename T::key_type> key{};
+
+		while (it != end && *it != '}')
+		{
+			const auto key_result = parse(it, end, key, string);
+
+			if (!key_result.success)
+				return failure(key_result.it);
+
+			if (!skip_whitespace(it = key_result.it, end))
+				return failure(it);
+
+			if (*it != ':')
+				return failure(it);
+
+			if (!skip_whitespace(++it, end))
+				return failure(it);
+
+			auto entry = value.find(key);
+
+			if (entry == value.end())
+				entry = value.emplace(key, typename T::mapped_type{}).first;
+
+			seen_entries.push_back(&*entry);
+
+			const parse_result value_result = parse(it, end, entry->second, value_type_descriptor);
+
+			if (!value_result.success)
+				return failure(value_result.it);
+
+			if (!skip_whitespace(it = value_result.it, end))
+				return failure(it);
+
+			if (*it == ',')
+				skip_whitespace(++it, end);
+		}
+
+		if (it == end)
+			return failure(it);
+
+		const auto seen_begin = seen_entries.begin() + first_seen;
+		std::sort(seen_begin, seen_entries.end(), std::less<>{});
+
+		std::erase_if(value, [&](const auto& kept) {
+			return !std::binary_search(seen_begin, seen_entries.end(), static_cast<const void*>(&kept), std::less<>{});
+		});
+
+		seen_entries.resize(first_seen);
+
+		return parse_result{ it + 1, true };
+	}
+
+	// keys set to null are erased, the others are merged into the entry they name
+	template <typename T>
+	parse_result merge_object(iterator it, const iterator end, T& value, const auto& value_type_descriptor)
+	{
+		using mapped_type = T::mapped_type;
+
+		if (it == end || *it != '{')
+			return parse_result{ it, false };
+
+		if (!skip_whitespace(++it, end))
+			return parse_result{ it, false };
+
+		std::remove_const_t<typename T::key_type> key{};
+
+		while (it != end && *it != '}')
+		{
+			const auto key_result = parse(it, end, key, string);
+
+			if (!key_result.success)
+				return key_result;
+
+			if (!skip_whitespace(it = key_result.it, end))
+				return parse_result{ it, false };
+
+			if (*it != ':')
+				return parse_result{ it, false };
+
+			if (!skip_whitespace(++it, end))
+				return parse_result{ it, false };
+
+			parse_result value_result;
+
+			if (match_literal(it, end, literals::null))
+			{
+				value.erase(key);
+				value_result = parse_result{ it + literals::null.size(), true };
+			}
+			else if (const auto entry = value.find(key); entry != value.end())
+			{
+				value_result = parse(it, end, entry->second, value_type_descriptor);
+			}
+			else
+			{
+				mapped_type mapped{};
+				value_result = parse(it, end, mapped, value_type_descriptor);
+				value.emplace(key, std::move(mapped));
+			}
+
+			if (!value_result.success)
+				return value_result;
+
+			if (!skip_whitespace(it = value_result.it, end))
+				return parse_result{ it, false };
+
+			if (*it == ',')
+				skip_whitespace(++it, end);
+		}
+
+		if (it == end)
+			return parse_result{ it, false };
+
+		return parse_result{ it + 1, true };
+	}
+
 	template <typename T>
 	parse_result parse_object(iterator it, const iterator end, T& value, const auto& value_type_descriptor)
 	{
@@ -259,7 +930,24 @@ private:
 		using key_type = std::remove_const_t<typename value_type::first_type>;
 		using mapped_type = value_type::second_type;
 
-		if (*it != '{')
+		if constexpr (Keyed<T>)
+		{
+			if (merging)
+				return merge_object(it, end, value, value_type_descriptor);
+		}
+
+		if constexpr (NodeBased<T>)
+		{
+			if (update)
+				return update_object(it, end, value, value_type_descriptor);
+		}
+		else if constexpr (Clearable<T>)
+		{
+			if (update)
+				value.clear();
+		}
+
+		if (it == end || *it != '{')
 			return parse_result{ it, false };
 
 		if (!skip_whitespace(++it, end))
@@ -310,20 +998,195 @@ private:
 		return parse_result{ it + 1, true };
 	}
 
+	// finds the end of the value starting at it without storing it anywhere
+	parse_result skip_value(iterator it, const iterator end)
+	{
+		if (it == end)
+			return parse_result{ it, false };
+
+		switch (*it)
+		{
+		case '"':
+			for (++it; (it = simd::find_quote_or_backslash(it, end)) != end; it += 2)
+			{
+				if (*it == '"')
+					return parse_result{ it + 1, true };
+
+				if (end - it < 2)
+					return parse_result{ end, false };
+			}
+
+			return parse_result{ it, false };
+		case '[':
+		case '{': {
+			const bool is_object = *it == '{';
+			const char close = is_object ? '}' : ']';
+
+			if (!skip_whitespace(++it, end))
+				return parse_result{ it, false };
+
+			while (it != end && *it != close)
+			{
+				if (is_object)
+				{
+					if (*it != '"')
+						return parse_result{ it, false };
+
+					const auto key_result = skip_value(it, end);
+
+					if (!key_result.success)
+						return key_result;
+
+					if (!skip_whitespace(it = key_result.it, end) || *it != ':')
+						return parse_result{ it, false };
+
+					if (!skip_whitespace(++it, end))
+						return parse_result{ it, false };
+				}
+
+				const auto result = skip_value(it, end);
+
+				if (!result.success)
+					return result;
+
+				if (!skip_whitespace(it = result.it, end))
+					return parse_result{ it, false };
+
+				if (*it == ',')
+					skip_whitespace(++it, end);
+			}
+
+			if (it == end)
+				return parse_result{ it, false };
+
+			return parse_result{ it + 1, true };
+		}
+		case 't':
+			return match_literal(it, end, literals::true_) ? parse_result{ it + literals::true_.size(), true } : parse_result{ it, false };
+		case 'f':
+			return match_literal(it, end, literals::false_) ? parse_result{ it + literals::false_.size(), true } : parse_result{ it, false };
+		case 'n':
+			return match_literal(it, end, literals::null) ? parse_result{ it + literals::null.size(), true } : parse_result{ it, false };
+		default: {
+			const iterator number_end = detail::scan_number(it, end);
+			return parse_result{ number_end, number_end != it };
+		}
+		}
+	}
+
+	// appends the value to the tape, containers are written as they're parsed and patched on close
+	parse_result parse_any(iterator it, const iterator end, tape& value)
+	{
+		if (it == end)
+			return parse_result{ it, false };
+
+		switch (*it)
+		{
+		case '"': {
+			const std::size_t offset = value.text.size();
+			const auto result = parse_string(it, end, value.text);
+			value.push_text(tape::string_tag, offset);
+			return result;
+		}
+		case '[':
+		case '{': {
+			const bool is_object = *it == '{';
+			const char close = is_object ? '}' : ']';
+			const std::size_t start = value.open(is_object ? tape::object_tag : tape::array_tag);
+
+			if (!skip_whitespace(++it, end))
+				return parse_result{ it, false };
+
+			std::uint64_t count{};
+
+			for (; it != end && *it != close; count++)
+			{
+				if (is_object)
+				{
+					const std::size_t offset = value.text.size();
+					const auto key_result = parse_string(it, end, value.text);
+
+					if (!key_result.success)
+						return key_result;
+
+					value.push_text(tape::string_tag, offset);
+
+					if (!skip_whitespace(it = key_result.it, end))
+						return parse_result{ it, false };
+
+					if (*it != ':')
+						return parse_result{ it, false };
+
+					if (!skip_whitespace(++it, end))
+						return parse_result{ it, false };
+				}
+
+				const auto result = parse_any(it, end, value);
+
+				if (!result.success)
+					return result;
+
+				if (!skip_whitespace(it = result.it, end))
+					return parse_result{ it, false };
+
+				if (*it == ',')
+					skip_whitespace(++it, end);
+			}
+
+			if (it == end)
+				return parse_result{ it, false };
+
+			value.close(start, count);
+			return parse_result{ it + 1, true };
+		}
+		case 't':
+		case 'f': {
+			bool b{};
+			const auto result = parse_boolean(it, end, b);
+			value.words.push_back(b ? tape::true_tag : tape::false_tag);
+			return result;
+		}
+		case 'n':
+			if (!match_literal(it, end, literals::null))
+				return parse_result{ it, false };
+
+			value.words.push_back(tape::null_tag);
+			return parse_result{ it + literals::null.size(), true };
+		default:
+			if (const iterator number_end = detail::scan_number(it, end); number_end != it)
+			{
+				const std::size_t offset = value.text.size();
+				value.text.append(it, number_end);
+				value.push_text(tape::number_tag, offset);
+				return parse_result{ number_end, true };
+			}
+
+			return parse_result{ it, false };
+		}
+	}
+
 	template <int Index, typename T, typename TFields> requires (is_field_list_v<TFields>)
-	parse_result parse_field(const iterator begin, const iterator end, const std::string& field_name, T& value, const TFields& fields)
+	parse_result parse_field(const iterator begin, const iterator end, const std::string_view field_name, T& value, const TFields& fields, std::bitset<member_count_v<TFields>>& seen)
 	{
 		const auto& field = std::get<Index>(fields);
 		if (field.name == field_name)
 		{
 			const auto& member_ptr = field.member_ptr;
+			seen.set(Index);
+
+			if (merging && match_literal(begin, end, literals::null))
+			{
+				assign(value.*member_ptr, default_value<T>().*member_ptr);
+				return parse_result{ begin + literals::null.size(), true };
+			}
+
 			return parse(begin, end, value.*member_ptr, field.descriptor);
 		}
 		else
 		{
 			if constexpr (Index + 1 < std::tuple_size_v<TFields>)
 			{
-				return parse_field<Index + 1>(begin, end, field_name, value, fields);
+				return parse_field<Index + 1>(begin, end, field_name, value, fields, seen);
 			}
 			else
 			{
@@ -332,19 +1195,46 @@ private:
 		}
 	}
 
+	// field names are compared in place, only keys containing escapes are decoded into storage
+	parse_result parse_key(const iterator begin, const iterator end, std::string_view& key, std::string& storage)
+	{
+		if (begin == end || *begin != '"')
+			return parse_result{ begin, false };
+
+		const iterator key_begin = begin + 1;
+		const iterator key_end = simd::find_quote_or_backslash(key_begin, end);
+
+		if (key_end == end)
+			return parse_result{ key_end, false };
+
+		if (*key_end == '"')
+		{
+			key = std::string_view{ key_begin, static_cast<std::size_t>(key_end - key_begin) };
+			return parse_result{ key_end + 1, true };
+		}
+
+		storage.clear();
+		const auto result = parse_string(begin, end, storage);
+		key = storage;
+		return result;
+	}
+
 	template <typename T, typename TFields> requires (is_field_list_v<TFields>)
 	parse_result parse_fields(iterator it, const iterator end, T& value, const TFields& fields)
 	{
-		if (*it != '{')
+		if (it == end || *it != '{')
 			return parse_result{ it, false };
 
 		if (!skip_whitespace(++it, end))
 			return parse_result{ it, false };
 
+		std::string escaped_key;
+		std::bitset<member_count_v<TFields>> seen;
+
 		while (it != end && *it != '}')
 		{
-			std::string key;
-			const auto key_result = parse(it, end, key, string);
+			std::string_view key;
+			const auto key_result = parse_key(it, end, key, escaped_key);
 
 			if (!key_result.success)
 				return key_result;
@@ -358,7 +1248,7 @@ private:
 			if (!skip_whitespace(++it, end))
 				return parse_result{ it, false };
 
-			const auto value_result = parse_field<0>(it, end, key, value, fields);
+			const auto value_result = parse_field<0>(it, end, key, value, fields, seen);
 
 			if (!value_result.success)
 				return value_result;
@@ -373,9 +1263,24 @@ private:
 		if (it == end)
 			return parse_result{ it, false };
 
+		if (update && !merging && !seen.all())
+			reset_missing(value, fields, seen);
+
 		return parse_result{ it + 1, true };
 	}
 
+	// gives the members that weren't in the object the values they'd have in a new T
+	template <typename T, typename TFields>
+	static void reset_missing(T& value, const TFields& fields, const std::bitset<member_count_v<TFields>>& seen)
+	{
+		std::size_t index{};
+
+		for_each_member(fields, [&](const auto& field) {
+			if (!seen[index++])
+				assign(value.*field.member_ptr, default_value<T>().*field.member_ptr);
+		});
+	}
+
 	template <int Index, typename T, typename TElements> requires (is_element_list_v<TElements>)
 	parse_result parse_element(iterator it, const iterator end, T& value, const TElements& elements)
 	{
@@ -411,7 +1316,7 @@ private:
 	template <typename T, typename TElements> requires (is_element_list_v<TElements>)
 	parse_result parse_elements(iterator it, const iterator end, T& value, const TElements& elements)
 	{
-		if (*it != '[')
+		if (it == end || *it != '[')
 			return parse_result{ it, false };
 
 		if (!skip_whitespace(++it, end))
@@ -0,0 +1,875 @@
+#ifndef __JSON_PATCH_HPP
+#define __JSON_PATCH_HPP
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <iterator>
+#include <ranges>
+
+#include "json.hpp"
+#include "reflection.hpp"
+#include "parser.hpp"
+#include "stringifier.hpp"
+#include "compare.hpp"
+
+namespace json
+{
+
+// applies the json merge patch (RFC 7396) in buffer to value, see parser::merge_patch. Returns false if
+// the patch doesn't parse, in which case the value may be partly patched.
+inline bool merge_patch(const std::string_view buffer, auto& value, const auto& descriptor)
+{
+	return parser{}.merge_patch(buffer, value, descriptor);
+}
+
+// Applies json patches (RFC 6902) to native values. Each operation's path (a JSON Pointer) is followed
+// through the descriptor: field names, element and array indices, and map keys. Values are parsed from
+// the patch straight into their place, in the parser's update mode.
+//
+// add, remove, replace and test are supported. Removing a field resets it to the value it has in a new
+// object. Element lists and fixed size arrays can't be added to or removed from. Operations are applied
+// in order and the first one that fails stops the patch, leaving the ones before it applied.
+//
+// With the descriptor given as a template argument, field names are looked up in tables sorted at
+// compile time rather than compared with each field in turn.
+struct patcher
+{
+public:
+	bool operator()(const std::string_view patch, auto& value, const auto& descriptor)
+	{
+		return apply_all(patch, value, descriptor, runtime_descriptor{});
+	}
+
+	// for descriptors declared constexpr with static storage
+	template <const auto& Descriptor>
+	bool operator()(const std::string_view patch, auto& value)
+	{
+		return apply_all(patch, value, Descriptor, static_descriptor<Descriptor>{});
+	}
+
+private:
+	using iterator = parser::iterator;
+	using parse_result = parser::parse_result;
+
+	enum class operation
+	{
+		add,
+		remove,
+		replace,
+		test,
+	};
+
+	// stands in for a static_descriptor when the descriptor is only known at runtime
+	struct runtime_descriptor
+	{
+		template <std::size_t>
+		using child = runtime_descriptor;
+	};
+
+	parser parse{};
+	comparer compare{};
+
+	std::string op;
+	std::string path;
+	std::string escaped_key;
+	std::string token;
+
+	bool apply_all(const std::string_view patch, auto& value, const auto& descriptor, const auto at)
+	{
+		parse.update = true;
+
+		iterator it = patch.data();
+		const iterator end = it + patch.size();
+
+		if (!parse.skip_whitespace(it, end) || *it != '[')
+			return false;
+
+		if (!parse.skip_whitespace(++it, end))
+			return false;
+
+		while (it != end && *it != ']')
+		{
+			const auto result = apply_operation(it, end, value, descriptor, at);
+
+			if (!result.success)
+				return false;
+
+			if (!parse.skip_whitespace(it = result.it, end))
+				return false;
+
+			if (*it == ',')
+				parse.skip_whitespace(++it, end);
+		}
+
+		return it != end;
+	}
+
+	// the members of an operation can come in any order, so the value is only located at first
+	template <typename T, typename TDesc>
+	parse_result apply_operation(iterator it, const iterator end, T& value, const TDesc& descriptor, const auto at)
+	{
+		if (it == end || *it != '{')
+			return parse_result{ it, false };
+
+		if (!parse.skip_whitespace(++it, end))
+			return parse_result{ it, false };
+
+		bool has_op{}, has_path{}, has_value{};
+		std::string_view text;
+
+		while (it != end && *it != '}')
+		{
+			std::string_view key;
+			const auto key_result = parse.parse_key(it, end, key, escaped_key);
+
+			if (!key_result.success)
+				return key_result;
+
+			if (!parse.skip_whitespace(it = key_result.it, end) || *it != ':')
+				return parse_result{ it, false };
+
+			if (!parse.skip_whitespace(++it, end))
+				return parse_result{ it, false };
+
+			parse_result result;
+
+			if (key == "op")
+			{
+				result = parse.parse(it, end, op, string);
+				has_op = true;
+			}
+			else if (key == "path")
+			{
+				result = parse.parse(it, end, path, string);
+				has_path = true;
+			}
+			else
+			{
+				result = parse.skip_value(it, end);
+
+				if (key == "value")
+				{
+					text = std::string_view{ it, static_cast<std::size_t>(result.it - it) };
+					has_value = true;
+				}
+			}
+
+			if (!result.success)
+				return result;
+
+			if (!parse.skip_whitespace(it = result.it, end))
+				return parse_result{ it, false };
+
+			if (*it == ',')
+				parse.skip_whitespace(++it, end);
+		}
+
+		if (it == end || !has_op || !has_path)
+			return parse_result{ it, false };
+
+		operation kind;
+
+		if (op == "add")
+			kind = operation::add;
+		else if (op == "remove")
+			kind = operation::remove;
+		else if (op == "replace")
+			kind = operation::replace;
+		else if (op == "test")
+			kind = operation::test;
+		else
+			return parse_result{ it, false };
+
+		if (kind != operation::remove && !has_value)
+			return parse_result{ it, false };
+
+		return parse_result{ it + 1, apply(value, descriptor, path, kind, text, at) };
+	}
+
+	// follows the pointer down to the member the last token names, and applies the operation there. at
+	// is where the descriptor is in one known at compile time, if it is.
+	template <typename T, typename TDesc>
+	bool apply(T& value, const TDesc& descriptor, std::string_view pointer, const operation kind, const std::string_view text, const auto at)
+	{
+		if (pointer.empty())
+			return apply_to(value, descriptor, kind, text);
+
+		if constexpr (is_optional_v<T>)
+		{
+			return value && apply(*value, descriptor, pointer, kind, text, at);
+		}
+		else
+		{
+			if (pointer.front() != '/')
+				return false;
+
+			pointer.remove_prefix(1);
+
+			const std::size_t slash = pointer.find('/');
+			const std::string_view name = decode(pointer.substr(0, slash));
+
+			if (slash == std::string_view::npos)
+				return apply_member(value, descriptor, name, kind, text, at);
+
+			pointer.remove_prefix(slash);
+
+			return with_member(value, descriptor, name, [&](auto& member, const auto& member_descriptor, const auto member_at) {
+				return apply(member, member_descriptor, pointer, kind, text, member_at);
+			}, at);
+		}
+	}
+
+	// the whole value can be replaced or tested, not removed
+	template <typename T, typename TDesc>
+	bool apply_to(T& value, const TDesc& descriptor, const operation kind, const std::string_view text)
+	{
+		switch (kind)
+		{
+		case operation::add:
+		case operation::replace:
+			return parse_into(value, descriptor, text);
+		case operation::test:
+			return equal_to(value, descriptor, text);
+		default:
+			return false;
+		}
+	}
+
+	template <typename T, typename TFields> requires (is_field_list_v<TFields>)
+	bool apply_member(T& value, const TFields& fields, const std::string_view name, const operation kind, const std::string_view text, const auto at)
+	{
+		if (kind != operation::remove)
+		{
+			return with_member(value, fields, name, [&](auto& member, const auto& member_descriptor, auto) {
+				return apply_to(member, member_descriptor, kind, text);
+			}, at);
+		}
+
+		return with_field(fields, name, [&](const auto& field, auto) {
+			assign(value.*field.member_ptr, default_value<T>().*field.member_ptr);
+			return true;
+		}, at);
+	}
+
+	template <typename T, typename TElements> requires (is_element_list_v<TElements>)
+	bool apply_member(T& value, const TElements& elements, const std::string_view name, const operation kind, const std::string_view text, const auto at)
+	{
+		if (kind == operation::add || kind == operation::remove)
+			return false;
+
+		return with_member(value, elements, name, [&](auto& member, const auto& member_descriptor, auto) {
+			return apply_to(member, member_descriptor, kind, text);
+		}, at);
+	}
+
+	// "-" adds to the end
+	template <typename T, typename TValueDesc>
+	bool apply_member(T& values, const array<TValueDesc>& descriptor, const std::string_view name, const operation kind, const std::string_view text, const auto at)
+	{
+		using value_type = underlying_value_type_t<T>;
+
+		if (kind == operation::add)
+		{
+			if constexpr (!std::is_bounded_array_v<T> && requires { values.insert(values.begin(), value_type{}); })
+			{
+				std::size_t index = values.size();
+
+				if (name != "-" && (!parse_index(name, index) || index > values.size()))
+					return false;
+
+				value_type element{};
+
+				if (!parse_into(element, descriptor.value_descriptor, text))
+					return false;
+
+				values.insert(std::next(values.begin(), index), std::move(element));
+				return true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		if (kind == operation::remove)
+		{
+			if constexpr (!std::is_bounded_array_v<T> && requires { values.erase(values.begin()); })
+			{
+				std::size_t index{};
+
+				if (!parse_index(name, index) || index >= values.size())
+					return false;
+
+				values.erase(std::next(values.begin(), index));
+				return true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return with_member(values, descriptor, name, [&](auto& element, const auto& element_descriptor, auto) {
+			return apply_to(element, element_descriptor, kind, text);
+		}, at);
+	}
+
+	template <typename T, typename TValueDesc>
+	bool apply_member(T& values, const object<TValueDesc>& descriptor, const std::string_view name, const operation kind, const std::string_view text, auto)
+	{
+		if constexpr (Keyed<T>)
+		{
+			const std::remove_const_t<typename T::key_type> key(name.begin(), name.end());
+
+			if (kind == operation::remove)
+				return values.erase(key) != 0;
+
+			if (const auto entry = values.find(key); entry != values.end())
+				return apply_to(entry->second, descriptor.value_descriptor, kind, text);
+
+			if (kind != operation::add)
+				return false;
+
+			typename T::mapped_type mapped{};
+
+			if (!parse_into(mapped, descriptor.value_descriptor, text))
+				return false;
+
+			values.emplace(key, std::move(mapped));
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// booleans, numbers, strings and any values have no members to point at
+	bool apply_member(auto&, const auto&, const std::string_view, const operation, const std::string_view, auto)
+	{
+		return false;
+	}
+
+	// calls f(field, where it is) with the field called name, if there's one
+	template <typename TFields>
+	bool with_field(const TFields& fields, const std::string_view name, auto&& f, runtime_descriptor)
+	{
+		bool result{};
+
+		for_each_member(fields, [&](const auto& field) {
+			if (name != field.name)
+				return true;
+
+			result = f(field, runtime_descriptor{});
+			return false;
+		});
+
+		return result;
+	}
+
+	template <typename TFields, const auto& Root, std::size_t... Steps>
+	bool with_field(const TFields& fields, const std::string_view name, auto&& f, static_descriptor<Root, Steps...>)
+	{
+		using at = static_descriptor<Root, Steps...>;
+		return with_index(fields, field_index<at>::find(name), f, at{});
+	}
+
+	// calls f(member, where it is) with the field or element at index, if there's one
+	template <typename TMembers>
+	static bool with_index(const TMembers& members, const std::size_t index, auto&& f, const auto at)
+	{
+		return [&]<std::size_t... Indices>(std::index_sequence<Indices...>) {
+			bool result{};
+			((index == Indices && (result = f(std::get<Indices>(members), typename decltype(at)::template child<Indices>{}), true)) || ...);
+			return result;
+		}(std::make_index_sequence<member_count_v<TMembers>>{});
+	}
+
+	// calls f(member, its descriptor, where that is) with the member the name points at, returns false
+	// if there isn't one
+	template <typename T, typename TFields> requires (is_field_list_v<TFields>)
+	bool with_member(T& value, const TFields& fields, const std::string_view name, auto&& f, const auto at)
+	{
+		return with_field(fields, name, [&](const auto& field, const auto field_at) {
+			return f(value.*field.member_ptr, field.descriptor, field_at);
+		}, at);
+	}
+
+	template <typename T, typename TElements> requires (is_element_list_v<TElements>)
+	bool with_member(T& value, const TElements& elements, const std::string_view name, auto&& f, const auto at)
+	{
+		std::size_t index{};
+
+		if (!parse_index(name, index))
+			return false;
+
+		return with_index(elements, index, [&](const auto& element, const auto element_at) {
+			return f(value.*element.member_ptr, element.descriptor, element_at);
+		}, at);
+	}
+
+	template <typename T, typename TValueDesc>
+	bool with_member(T& values, const array<TValueDesc>& descriptor, const std::string_view name, auto&& f, const auto at)
+	{
+		std::size_t index{};
+
+		if (!parse_index(name, index) || index >= std::ranges::size(values))
+			return false;
+
+		auto element = std::ranges::begin(values);
+		std::ranges::advance(element, index);
+
+		// the elements of sets can't be changed in place
+		if constexpr (std::is_const_v<std::remove_reference_t<decltype(*element)>>)
+			return false;
+		else
+			return f(*element, descriptor.value_descriptor, typename decltype(at)::template child<0>{});
+	}
+
+	template <typename T, typename TValueDesc>
+	bool with_member(T& values, const object<TValueDesc>& descriptor, const std::string_view name, auto&& f, const auto at)
+	{
+		if constexpr (Keyed<T>)
+		{
+			const auto entry = values.find(std::remove_const_t<typename T::key_type>(name.begin(), name.end()));
+			return entry != values.end() && f(entry->second, descriptor.value_descriptor, typename decltype(at)::template child<0>{});
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	bool with_member(auto&, const auto&, const std::string_view, auto&&, auto)
+	{
+		return false;
+	}
+
+	bool parse_into(auto& value, const auto& descriptor, const std::string_view text)
+	{
+		return parse.parse(text.data(), text.data() + text.size(), value, descriptor).success;
+	}
+
+	template <typename T>
+	bool equal_to(const T& value, const auto& descriptor, const std::string_view text)
+	{
+		T expected{};
+		return parse_into(expected, descriptor, text) && compare.equal(expected, value, descriptor);
+	}
+
+	// array indices are plain decimal numbers without leading zeros
+	static bool parse_index(const std::string_view name, std::size_t& index)
+	{
+		if (name.empty() || (name.size() > 1 && name.front() == '0'))
+			return false;
+
+		const auto [end, ec] = std::from_chars(name.data(), name.data() + name.size(), index);
+		return ec == std::errc{} && end == name.data() + name.size();
+	}
+
+	// undoes the pointer's escaping of '~' and '/' as "~0" and "~1"
+	std::string_view decode(const std::string_view name)
+	{
+		if (name.find('~') == std::string_view::npos)
+			return name;
+
+		token.clear();
+
+		for (std::size_t i = 0; i < name.size(); i++)
+		{
+			if (name[i] == '~' && i + 1 < name.size() && (name[i + 1] == '0' || name[i + 1] == '1'))
+				token += name[++i] == '0' ? '~' : '/';
+			else
+				token += name[i];
+		}
+
+		return token;
+	}
+};
+
+// applies the json patch (RFC 6902) in buffer to value, see patcher
+inline bool apply_patch(const std::string_view buffer, auto& value, const auto& descriptor)
+{
+	return patcher{}(buffer, value, descriptor);
+}
+
+// the same with the descriptor known at compile time, see patcher
+template <const auto& Descriptor>
+inline bool apply_patch(const std::string_view buffer, auto& value)
+{
+	return patcher{}.template operator()<Descriptor>(buffer, value);
+}
+
+namespace detail
+{
+// containers whose elements can't be changed in place, like sets
+template <typename T>
+constexpr bool has_const_elements_v = std::is_const_v<std::remove_reference_t<std::iter_reference_t<std::ranges::iterator_t<T>>>>;
+
+// sets holding each element once
+template <typename T>
+concept UniqueSet = requires(T& t, const std::ranges::range_value_t<T>& v) { { t.insert(v).second }; { t.contains(v) }; };
+}
+
+// Writes the difference between two values of the same type as a json patch (RFC 6902), or as a merge
+// patch (RFC 7396) when merge is set, walking both values through the descriptor side by side.
+//
+// Only what changed is written: fields and elements are compared one by one, arrays element by
+// element up to the shorter one's length and then cut or extended at the end, sets by the elements
+// removed and added, and maps key by key.
+// Applying the patch to from with apply_patch or merge_patch gives to. Merge patches can't tell an
+// optional that's empty from one that isn't there, so both are written as null.
+struct differ
+{
+public:
+	bool merge{}; // writes a merge patch instead of a json patch
+
+	std::string operator()(const auto& from, const auto& to, const auto& descriptor)
+	{
+		std::string out;
+
+		{
+			string_sink os{ out };
+			write(static_cast<sink&>(os), from, to, descriptor);
+		}
+
+		return out;
+	}
+
+	void operator()(std::ostream& os, const auto& from, const auto& to, const auto& descriptor)
+	{
+		write(os, from, to, descriptor);
+	}
+
+	// call os.flush() once done if the sink outlives the call
+	void operator()(sink& os, const auto& from, const auto& to, const auto& descriptor)
+	{
+		write(os, from, to, descriptor);
+	}
+
+private:
+	stringifier format{};
+	comparer compare{};
+
+	std::string path; // the pointer to the values being compared
+	bool first{}; // no operation written yet
+
+	template <typename T, typename TDesc>
+	void write(auto& os, const T& from, const T& to, const TDesc& descriptor)
+	{
+		format.dense = true;
+		path.clear();
+
+		if (merge)
+		{
+			merge_value(os, from, to, descriptor);
+			return;
+		}
+
+		os << '[';
+		first = true;
+		diff(os, from, to, descriptor);
+		os << ']';
+	}
+
+	template <typename T, typename TDesc>
+	bool same(const T& from, const T& to, const TDesc& descriptor)
+	{
+		return compare.equal(from, to, descriptor);
+	}
+
+	void push(const std::string_view name)
+	{
+		path += '/';
+
+		for (const char c : name)
+		{
+			if (c == '~')
+				path += "~0";
+			else if (c == '/')
+				path += "~1";
+			else
+				path += c;
+		}
+	}
+
+	void push(const std::size_t index)
+	{
+		char digits[24];
+		const auto result = std::to_chars(digits, digits + sizeof(digits), index);
+
+		path += '/';
+		path.append(digits, result.ptr);
+	}
+
+	void write_operation(auto& os, const char* const op)
+	{
+		if (!first)
+			os << ',';
+
+		first = false;
+
+		os << "{\"op\":\"" << op << "\",\"path\":";
+		format(os, path, string);
+	}
+
+	void write_operation(auto& os, const char* const op, const auto& value, const auto& descriptor)
+	{
+		write_operation(os, op);
+		os << ",\"value\":";
+		format(os, value, descriptor);
+		os << '}';
+	}
+
+	// booleans, numbers, strings and any values are replaced as a whole
+	template <typename T, typename TDesc>
+	void diff(auto& os, const T& from, const T& to, const TDesc& descriptor)
+	{
+		if (!same(from, to, descriptor))
+			write_operation(os, "replace", to, descriptor);
+	}
+
+	template <typename T, typename TDesc>
+	void diff(auto& os, const std::optional<T>& from, const std::optional<T>& to, const TDesc& descriptor)
+	{
+		if (from && to)
+			diff(os, *from, *to, descriptor);
+		else if (from || to)
+			write_operation(os, "replace", to, descriptor);
+	}
+
+	template <typename T, typename TMembers> requires (is_field_list_v<TMembers> || is_element_list_v<TMembers>)
+	void diff(auto& os, const T& from, const T& to, const TMembers& members)
+	{
+		std::size_t index{};
+
+		for_each_member(members, [&](const auto& member) {
+			const std::size_t length = path.size();
+
+			if constexpr (is_field_v<std::remove_cvref_t<decltype(member)>>)
+				push(member.name);
+			else
+				push(index++);
+
+			diff(os, from.*member.member_ptr, to.*member.member_ptr, member.descriptor);
+			path.resize(length);
+		});
+	}
+
+	// removes from the end first, so the indices of the elements before stay put
+	template <typename T, typename TValueDesc>
+	void diff(auto& os, const T& from, const T& to, const array<TValueDesc>& descriptor)
+	{
+		if constexpr (detail::has_const_elements_v<T>)
+		{
+			diff_set(os, from, to, descriptor);
+			return;
+		}
+
+		const std::size_t from_size = std::ranges::size(from);
+		const std::size_t to_size = std::ranges::size(to);
+		const std::size_t length = path.size();
+
+		auto from_it = std::ranges::begin(from);
+		auto to_it = std::ranges::begin(to);
+
+		for (std::size_t i = 0; i < from_size && i < to_size; i++, ++from_it, ++to_it)
+		{
+			push(i);
+			diff(os, *from_it, *to_it, descriptor.value_descriptor);
+			path.resize(length);
+		}
+
+		for (std::size_t i = from_size; i > to_size; i--)
+		{
+			push(i - 1);
+			write_operation(os, "remove");
+			os << '}';
+			path.resize(length);
+		}
+
+		for (; to_it != std::ranges::end(to); ++to_it)
+		{
+			push("-");
+			write_operation(os, "add", *to_it, descriptor.value_descriptor);
+			path.resize(length);
+		}
+	}
+
+	// elements of sets can't be replaced, so the ones that went are removed and the new ones added. Each
+	// removal moves the elements after it down one. Sets that can hold an element more than once are
+	// replaced as a whole.
+	template <typename T, typename TValueDesc>
+	void diff_set(auto& os, const T& from, const T& to, const array<TValueDesc>& descriptor)
+	{
+		if constexpr (detail::UniqueSet<T>)
+		{
+			const std::size_t length = path.size();
+			std::size_t index{};
+
+			for (const auto& element : from)
+			{
+				if (to.contains(element))
+				{
+					index++;
+					continue;
+				}
+
+				push(index);
+				write_operation(os, "remove");
+				os << '}';
+				path.resize(length);
+			}
+
+			for (const auto& element : to)
+			{
+				if (!from.contains(element))
+				{
+					push("-");
+					write_operation(os, "add", element, descriptor.value_descriptor);
+					path.resize(length);
+				}
+			}
+		}
+		else if (!same(from, to, descriptor))
+		{
+			write_operation(os, "replace", to, descriptor);
+		}
+	}
+
+	template <typename T, typename TValueDesc>
+	void diff(auto& os, const T& from, const T& to, const object<TValueDesc>& descriptor)
+	{
+		if constexpr (Keyed<T>)
+		{
+			const std::size_t length = path.size();
+
+			for (const auto& [key, value] : from)
+			{
+				push(key);
+
+				if (const auto entry = to.find(key); entry != to.end())
+				{
+					diff(os, value, entry->second, descriptor.value_descriptor);
+				}
+				else
+				{
+					write_operation(os, "remove");
+					os << '}';
+				}
+
+				path.resize(length);
+			}
+
+			for (const auto& [key, value] : to)
+			{
+				if (from.find(key) == from.end())
+				{
+					push(key);
+					write_operation(os, "add", value, descriptor.value_descriptor);
+					path.resize(length);
+				}
+			}
+		}
+		else if (!same(from, to, descriptor))
+		{
+			write_operation(os, "replace", to, descriptor);
+		}
+	}
+
+	// a merge patch only goes into objects, everything else that changed is written as it is now
+	template <typename T, typename TDesc>
+	void merge_value(auto& os, const T& from, const T& to, const TDesc& descriptor)
+	{
+		if constexpr (is_optional_v<T>)
+		{
+			if (from && to)
+				merge_value(os, *from, *to, descriptor);
+			else
+				format(os, to, descriptor);
+		}
+		else if constexpr (is_field_list_v<TDesc>)
+		{
+			os << '{';
+			bool first_member = true;
+
+			for_each_member(descriptor, [&](const auto& field) {
+				merge_member(os, first_member, field.name, from.*field.member_ptr, to.*field.member_ptr, field.descriptor);
+			});
+
+			os << '}';
+		}
+		else if constexpr (detail::is_object_descriptor_v<TDesc> && Keyed<T>)
+		{
+			os << '{';
+			bool first_member = true;
+
+			for (const auto& [key, value] : from)
+			{
+				if (const auto entry = to.find(key); entry != to.end())
+				{
+					merge_member(os, first_member, key, value, entry->second, descriptor.value_descriptor);
+				}
+				else
+				{
+					write_key(os, first_member, key);
+					os << literals::null;
+				}
+			}
+
+			for (const auto& [key, value] : to)
+			{
+				if (from.find(key) == from.end())
+				{
+					write_key(os, first_member, key);
+					format(os, value, descriptor.value_descriptor);
+				}
+			}
+
+			os << '}';
+		}
+		else
+		{
+			format(os, to, descriptor);
+		}
+	}
+
+	void merge_member(auto& os, bool& first_member, const auto& key, const auto& from, const auto& to, const auto& descriptor)
+	{
+		if (same(from, to, descriptor))
+			return;
+
+		write_key(os, first_member, key);
+		merge_value(os, from, to, descriptor);
+	}
+
+	void write_key(auto& os, bool& first_member, const auto& key)
+	{
+		if (!first_member)
+			os << ',';
+
+		first_member = false;
+
+		format(os, key, string);
+		os << ':';
+	}
+};
+
+// the json patch (RFC 6902) that turns from into to, see differ
+inline std::string diff(const auto& from, const auto& to, const auto& descriptor)
+{
+	return differ{}(from, to, descriptor);
+}
+
+// the merge patch (RFC 7396) that turns from into to, see differ
+inline std::string merge_diff(const auto& from, const auto& to, const auto& descriptor)
+{
+	differ merge_differ{};
+	merge_differ.merge = true;
+	return merge_differ(from, to, descriptor);
+}
+
+} // json
+
+#endif // __JSON_PATCH_HPP
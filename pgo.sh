@@ -0,0 +1,45 @@
+#!/bin/sh
+# Profile guided build of the tests and benchmark.
+#
+# Builds the lto preset as a baseline, builds the pgo-generate preset and runs bench on the
+# synthetic corpus to collect profiles, rebuilds with the pgo-use preset, checks the tests still
+# pass, and reports the speedup of the optimised bench over the baseline.
+#
+# usage: ./pgo.sh [records] [repetitions]
+
+set -eu
+
+cd "$(dirname "$0")"
+
+records=${1:-20000}
+repetitions=${2:-5}
+profile_dir=build/pgo-profile
+
+bench_total() {
+	"$1" "$records" "$repetitions" | tee /dev/stderr | sed -n 's/^total: \([0-9.]*\) ms$/\1/p'
+}
+
+echo "== baseline (lto)"
+cmake --preset lto > /dev/null
+cmake --build --preset lto
+baseline=$(bench_total build/lto/bench)
+
+echo "== collecting profiles (pgo-generate)"
+rm -rf "$profile_dir"
+cmake --preset pgo-generate > /dev/null
+cmake --build --preset pgo-generate
+build/pgo/bench "$records" "$repetitions" > /dev/null
+
+if ls "$profile_dir"/*.profraw > /dev/null 2>&1; then
+	# clang writes raw profiles which have to be merged before they can be used
+	${LLVM_PROFDATA:-llvm-profdata} merge -output="$profile_dir/default.profdata" "$profile_dir"/*.profraw
+fi
+
+echo "== optimised (pgo-use)"
+cmake --preset pgo-use > /dev/null
+cmake --build --preset pgo-use
+ctest --test-dir build/pgo --output-on-failure
+optimised=$(bench_total build/pgo/bench)
+
+echo "== lto: $baseline ms, pgo: $optimised ms"
+awk -v a="$baseline" -v b="$optimised" 'BEGIN { printf "speedup: %.2fx\n", a / b }'
@@ -0,0 +1,299 @@
+#ifndef __JSON_READER_HPP
+#define __JSON_READER_HPP
+
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <cstring>
+#include <cerrno>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define JSON_HAS_POSIX_IO
+#endif
+
+#include "simd.hpp"
+
+namespace json
+{
+
+// where a buffered_reader gets its bytes from
+class source
+{
+public:
+	virtual ~source() = default;
+
+	// reads up to size bytes into buffer, returns 0 at the end of the input or on error
+	virtual std::size_t read(char* buffer, std::size_t size) = 0;
+};
+
+class istream_source : public source
+{
+public:
+	explicit istream_source(std::istream& is) : is{ is } {}
+
+	std::size_t read(char* buffer, const std::size_t size) override
+	{
+		return static_cast<std::size_t>(is.rdbuf()->sgetn(buffer, static_cast<std::streamsize>(size)));
+	}
+
+private:
+	std::istream& is;
+};
+
+// reads from a buffer in memory, which must outlive it
+class memory_source : public source
+{
+public:
+	explicit memory_source(const std::string_view data) : data{ data } {}
+
+	std::size_t read(char* buffer, const std::size_t size) override
+	{
+		const std::size_t count = data.copy(buffer, size);
+		data.remove_prefix(count);
+		return count;
+	}
+
+private:
+	std::string_view data;
+};
+
+#ifdef JSON_HAS_POSIX_IO
+class fd_source : public source
+{
+public:
+	explicit fd_source(const int fd) : fd{ fd } {}
+
+	int error{}; // errno of the failed read, if any
+
+	std::size_t read(char* buffer, const std::size_t size) override
+	{
+		for (;;)
+		{
+			if (const ssize_t n = ::read(fd, buffer, size); n >= 0)
+				return static_cast<std::size_t>(n);
+
+			if (errno != EINTR)
+			{
+				error = errno;
+				return 0;
+			}
+		}
+	}
+
+private:
+	int fd;
+};
+#endif
+
+// Finds where a top-level json value ends without parsing it. It keeps its state between calls, so
+// input can be fed to it as it arrives.
+class value_scanner
+{
+public:
+	static constexpr std::size_t incomplete = static_cast<std::size_t>(-1);
+
+	// scans [begin, end) continuing from the previous call, returns the offset from begin just past
+	// the end of the value, or incomplete. A top-level number or literal is only known to be complete
+	// once something follows it, or at the end of the input.
+	std::size_t scan(const char* const begin, const char* const end, const bool at_eof)
+	{
+		for (const char* it = begin; it != end; ++it)
+		{
+			if (in_string)
+			{
+				if (escaped)
+				{
+					escaped = false;
+					continue;
+				}
+
+				if (it = simd::find_quote_or_backslash(it, end); it == end)
+					break;
+
+				if (*it == '\\')
+				{
+					escaped = true;
+					continue;
+				}
+
+				in_string = false;
+
+				if (depth == 0)
+					return complete(begin, it + 1);
+
+				continue;
+			}
+
+			if (in_scalar)
+			{
+				if (is_delimiter(*it))
+					return complete(begin, it);
+
+				continue;
+			}
+
+			// inside a container only brackets and strings matter
+			if (depth > 0)
+			{
+				if (it = simd::find_structural(it, end); it == end)
+					break;
+			}
+
+			switch (*it)
+			{
+			case '{':
+			case '[':
+				depth++;
+				break;
+			case '}':
+			case ']':
+				if (--depth <= 0)
+					return complete(begin, it + 1);
+				break;
+			case '"':
+				in_string = true;
+				break;
+			default:
+				if (depth == 0 && !is_whitespace(*it))
+					in_scalar = true;
+				break;
+			}
+		}
+
+		if (at_eof && in_scalar)
+			return complete(begin, end);
+
+		return incomplete;
+	}
+
+	bool started() const { return depth != 0 || in_string || in_scalar; }
+
+	void reset() { *this = value_scanner{}; }
+
+	static bool is_whitespace(const char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+private:
+	int depth{};
+	bool in_string{};
+	bool escaped{};
+	bool in_scalar{};
+
+	static bool is_delimiter(const char c)
+	{
+		return is_whitespace(c) || c == ',' || c == ']' || c == '}' || c == '[' || c == '{' || c == '"';
+	}
+
+	std::size_t complete(const char* const begin, const char* const value_end)
+	{
+		reset();
+		return static_cast<std::size_t>(value_end - begin);
+	}
+};
+
+// Reads consecutive top-level values (a document, or newline delimited records) from a source
+// through a large buffer, refilling it between values so the input never has to be held in full.
+// A value bigger than the buffer grows it.
+class buffered_reader
+{
+public:
+	static constexpr std::size_t default_buffer_size = 1 << 20;
+
+	explicit buffered_reader(std::unique_ptr<source> src, const std::size_t buffer_size = default_buffer_size)
+		: src{ std::move(src) }, capacity{ buffer_size < 16 ? 16 : buffer_size }, buffer{ new char[capacity] }
+	{
+	}
+
+	explicit buffered_reader(std::istream& is, const std::size_t buffer_size = default_buffer_size)
+		: buffered_reader{ std::make_unique<istream_source>(is), buffer_size }
+	{
+	}
+
+#ifdef JSON_HAS_POSIX_IO
+	explicit buffered_reader(const int fd, const std::size_t buffer_size = default_buffer_size)
+		: buffered_reader{ std::make_unique<fd_source>(fd), buffer_size }
+	{
+	}
+#endif
+
+	// the next value, valid until the following call, or nothing at the end of the input or if it
+	// ends part way through a value
+	std::optional<std::string_view> next()
+	{
+		for (;;)
+		{
+			while (begin != end && !scanner.started() && value_scanner::is_whitespace(buffer[begin]))
+				scanned = ++begin;
+
+			if (const std::size_t n = scanner.scan(buffer.get() + scanned, buffer.get() + end, at_eof); n != value_scanner::incomplete)
+			{
+				const std::string_view value{ buffer.get() + begin, scanned + n - begin };
+				begin = scanned = scanned + n;
+				return value;
+			}
+
+			scanned = end;
+
+			if (at_eof)
+			{
+				truncated = scanner.started();
+				return std::nullopt;
+			}
+
+			refill();
+		}
+	}
+
+	// true once all the input has been consumed
+	bool eof() const { return at_eof && begin == end; }
+
+	// true if the input ended part way through a value
+	bool failed() const { return truncated; }
+
+	// how much has been read from the source past the last value handed out
+	std::size_t buffered() const { return end - begin; }
+
+	// starts over on whatever the source reads next, keeping the buffer
+	void reset()
+	{
+		begin = scanned = end = 0;
+		scanner.reset();
+		at_eof = truncated = false;
+	}
+
+private:
+	std::unique_ptr<source> src;
+	std::size_t capacity;
+	std::unique_ptr<char[]> buffer;
+	std::size_t begin{}, scanned{}, end{};
+	value_scanner scanner{};
+	bool at_eof{};
+	bool truncated{};
+
+	void refill()
+	{
+		if (begin != 0)
+		{
+			std::memmove(buffer.get(), buffer.get() + begin, end - begin);
+			scanned -= begin;
+			end -= begin;
+			begin = 0;
+		}
+		else if (end == capacity)
+		{
+			std::unique_ptr<char[]> grown{ new char[capacity * 2] };
+			std::memcpy(grown.get(), buffer.get(), end);
+			buffer = std::move(grown);
+			capacity *= 2;
+		}
+
+		const std::size_t n = src->read(buffer.get() + end, capacity - end);
+		at_eof = n == 0;
+		end += n;
+	}
+};
+
+} // json
+
+#endif // __JSON_READER_HPP
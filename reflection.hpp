@@ -0,0 +1,181 @@
+#ifndef __JSON_REFLECTION_HPP
+#define __JSON_REFLECTION_HPP
+
+// Compile-time iteration over field and element lists, so tools working on any described type
+// (hashing, comparing, converting...) don't have to repeat the recursion of the parser and
+// stringifier.
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <array>
+#include <string_view>
+#include <algorithm>
+
+#include "json.hpp"
+
+namespace json
+{
+
+template <typename T>
+constexpr bool is_field_v = false;
+
+template <typename TStructure, typename TValue, typename TDescriptor>
+constexpr bool is_field_v<field<TStructure, TValue, TDescriptor>> = true;
+
+template <typename T>
+constexpr bool is_element_v = false;
+
+template <typename TContainer, typename TValue, typename TDescriptor>
+constexpr bool is_element_v<element<TContainer, TValue, TDescriptor>> = true;
+
+// a field list or an element list
+template <typename T>
+concept Members = is_field_list_v<T> || is_element_list_v<T>;
+
+// =====
+
+// the types a field or an element is made of
+template <typename T>
+struct member_traits;
+
+template <typename TStructure, typename TValue, typename TDescriptor>
+struct member_traits<field<TStructure, TValue, TDescriptor>>
+{
+	using structure_type = TStructure;
+	using value_type = TValue;
+	using descriptor_type = TDescriptor;
+};
+
+template <typename TContainer, typename TValue, typename TDescriptor>
+struct member_traits<element<TContainer, TValue, TDescriptor>>
+{
+	using structure_type = TContainer;
+	using value_type = TValue;
+	using descriptor_type = TDescriptor;
+};
+
+template <typename T>
+using member_value_t = typename member_traits<std::remove_cvref_t<T>>::value_type;
+
+template <typename T>
+using member_structure_t = typename member_traits<std::remove_cvref_t<T>>::structure_type;
+
+template <typename T>
+using member_descriptor_t = typename member_traits<std::remove_cvref_t<T>>::descriptor_type;
+
+template <Members T>
+constexpr std::size_t member_count_v = std::tuple_size_v<std::remove_const_t<T>>;
+
+// =====
+
+namespace detail
+{
+// a visitor returning bool stops the iteration by returning false, any other visitor goes through
+constexpr bool visit_one(auto& visitor, auto&&... args)
+{
+	if constexpr (std::is_same_v<std::invoke_result_t<decltype(visitor), decltype(args)...>, bool>)
+		return visitor(std::forward<decltype(args)>(args)...);
+	else
+	{
+		visitor(std::forward<decltype(args)>(args)...);
+		return true;
+	}
+}
+}
+
+// Calls visitor(member) with each field or element of the list in order, returns false if the
+// visitor returned false for one, which stops the iteration.
+template <Members TMembers>
+constexpr bool for_each_member(const TMembers& members, auto&& visitor)
+{
+	return [&]<std::size_t... Indices>(std::index_sequence<Indices...>) {
+		return (detail::visit_one(visitor, std::get<Indices>(members)) && ...);
+	}(std::make_index_sequence<member_count_v<TMembers>>{});
+}
+
+// Calls visitor(member, value.*member.member_ptr) with each field or element of the list in order,
+// the member's value being const if value is. Stops the same way as above.
+template <Members TMembers>
+constexpr bool for_each_member(auto&& value, const TMembers& members, auto&& visitor)
+{
+	return for_each_member(members, [&](const auto& member) {
+		return detail::visit_one(visitor, member, value.*member.member_ptr);
+	});
+}
+
+// =====
+
+namespace detail
+{
+template <std::size_t... Steps> requires (sizeof...(Steps) == 0)
+constexpr const auto& descend(const auto& descriptor)
+{
+	return descriptor;
+}
+
+// the descriptor reached by following steps down from this one: the index of a field or element in a
+// list, or 0 for the values of an array or object
+template <std::size_t Step, std::size_t... Steps>
+constexpr const auto& descend(const auto& descriptor)
+{
+	if constexpr (Members<std::remove_cvref_t<decltype(descriptor)>>)
+		return descend<Steps...>(std::get<Step>(descriptor).descriptor);
+	else
+		return descend<Steps...>(descriptor.value_descriptor);
+}
+}
+
+// A descriptor known at compile time: one declared constexpr with static storage, and the steps from
+// it down to a nested descriptor, so tables about it can be built once by the compiler.
+template <const auto& Root, std::size_t... Steps>
+struct static_descriptor
+{
+	static constexpr const auto& value = detail::descend<Steps...>(Root);
+
+	// the descriptor of field or element Step, or of the values for Step 0 of an array or object
+	template <std::size_t Step>
+	using child = static_descriptor<Root, Steps..., Step>;
+};
+
+template <const auto& Root, std::size_t... Steps>
+constexpr bool is_valid_descriptor_v<static_descriptor<Root, Steps...>> = true;
+
+// The field names of a field list known at compile time, sorted so that a name is found with a binary
+// search instead of comparing it with each field in turn.
+template <typename TStatic>
+struct field_index
+{
+	static constexpr std::size_t size = member_count_v<std::remove_cvref_t<decltype(TStatic::value)>>;
+
+	// the index of the field called name, or size if there isn't one
+	static constexpr std::size_t find(const std::string_view name)
+	{
+		const auto it = std::ranges::lower_bound(entries, name, {}, &entry::name);
+		return it != entries.end() && it->name == name ? it->index : size;
+	}
+
+private:
+	struct entry
+	{
+		std::string_view name;
+		std::size_t index;
+	};
+
+	static constexpr std::array<entry, size> entries = []() {
+		std::array<entry, size> entries{};
+		std::size_t index{};
+
+		for_each_member(TStatic::value, [&](const auto& field) {
+			entries[index] = entry{ field.name, index };
+			index++;
+		});
+
+		std::ranges::sort(entries, {}, &entry::name);
+		return entries;
+	}();
+};
+
+} // json
+
+#endif // __JSON_REFLECTION_HPP
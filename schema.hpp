@@ -0,0 +1,312 @@
+#ifndef __JSON_SCHEMA_HPP
+#define __JSON_SCHEMA_HPP
+
+// JSON Schema (draft 2020-12) generated from descriptors, so the structs stay the single source of
+// truth for what producers have to send. Everything is constexpr: json::schema<T>(desc) works at
+// compile time or at runtime, and json::schema_v<T, desc> is a string_view into static storage.
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include "json.hpp"
+#include "reflection.hpp"
+
+namespace json
+{
+
+namespace detail
+{
+template <typename T>
+constexpr std::size_t schema_extent_v = 0;
+
+template <typename T, std::size_t N>
+constexpr std::size_t schema_extent_v<T[N]> = N;
+
+template <typename T, std::size_t N>
+constexpr std::size_t schema_extent_v<std::array<T, N>> = N;
+
+constexpr void write_integer(std::string& out, const auto value)
+{
+	using value_type = std::remove_const_t<decltype(value)>;
+	using unsigned_type = std::make_unsigned_t<value_type>;
+
+	// the magnitude of the most negative value doesn't fit the signed type
+	const bool negative = std::is_signed_v<value_type> && value < value_type{};
+	unsigned_type magnitude = negative ? unsigned_type{} - static_cast<unsigned_type>(value) : static_cast<unsigned_type>(value);
+
+	char digits[24]{};
+	std::size_t n{};
+
+	do
+	{
+		digits[n++] = static_cast<char>('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+
+	if (negative)
+		out += '-';
+
+	while (n != 0)
+		out += digits[--n];
+}
+
+constexpr void write_quoted(std::string& out, const std::string_view s)
+{
+	constexpr char hex[] = "0123456789abcdef";
+
+	out += '"';
+
+	for (const char c : s)
+	{
+		if (c == '"' || c == '\\')
+		{
+			out += '\\';
+			out += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			out += "\\u00";
+			out += hex[static_cast<unsigned char>(c) >> 4];
+			out += hex[c & 0xf];
+		}
+		else
+		{
+			out += c;
+		}
+	}
+
+	out += '"';
+}
+
+template <typename T>
+constexpr void write_schema(std::string& out, const auto& descriptor);
+
+template <typename T>
+constexpr void write_number_schema(std::string& out)
+{
+	if constexpr (!std::is_integral_v<T>)
+	{
+		out += "{\"type\":\"number\"}";
+	}
+	else
+	{
+		out += "{\"type\":\"integer\"";
+
+		// 64 bit bounds are left to the consumer, not every validator handles them exactly
+		if constexpr (std::is_same_v<T, bool> || sizeof(T) < 8 || std::is_unsigned_v<T>)
+		{
+			out += ",\"minimum\":";
+			write_integer(out, static_cast<long long>(std::numeric_limits<T>::min()));
+		}
+
+		if constexpr (std::is_same_v<T, bool> || sizeof(T) < 8)
+		{
+			out += ",\"maximum\":";
+			write_integer(out, static_cast<long long>(std::numeric_limits<T>::max()));
+		}
+
+		out += '}';
+	}
+}
+
+template <typename T>
+constexpr bool is_decimal_v = false;
+
+template <int Scale, rounding Rounding>
+constexpr bool is_decimal_v<decimal_t<Scale, Rounding>> = true;
+
+// only exact decimals reject digits past their scale
+template <int Scale, rounding Rounding>
+constexpr void write_decimal_schema(std::string& out, const decimal_t<Scale, Rounding>&)
+{
+	if constexpr (Scale == 0 && Rounding == rounding::exact)
+	{
+		out += "{\"type\":\"integer\"}";
+	}
+	else
+	{
+		out += "{\"type\":\"number\"";
+
+		if constexpr (Rounding == rounding::exact)
+		{
+			out += ",\"multipleOf\":0.";
+			out.append(Scale - 1, '0');
+			out += "1";
+		}
+
+		out += '}';
+	}
+}
+
+template <typename T>
+constexpr void write_fields_schema(std::string& out, const auto& fields)
+{
+	out += "{\"type\":\"object\",\"properties\":{";
+
+	bool first = true;
+	for_each_member(fields, [&](const auto& field) {
+		if (!first)
+			out += ',';
+
+		first = false;
+		write_quoted(out, field.name);
+		out += ':';
+		write_schema<member_value_t<decltype(field)>>(out, field.descriptor);
+	});
+
+	out += "},\"required\":[";
+
+	first = true;
+	for_each_member(fields, [&](const auto& field) {
+		if constexpr (Mandatory<member_value_t<decltype(field)>>)
+		{
+			if (!first)
+				out += ',';
+
+			first = false;
+			write_quoted(out, field.name);
+		}
+	});
+
+	// the parser rejects keys it doesn't know
+	out += "],\"additionalProperties\":false}";
+}
+
+template <typename T>
+constexpr void write_elements_schema(std::string& out, const auto& elements)
+{
+	out += "{\"type\":\"array\",\"prefixItems\":[";
+
+	bool first = true;
+	for_each_member(elements, [&](const auto& element) {
+		if (!first)
+			out += ',';
+
+		first = false;
+		write_schema<member_value_t<decltype(element)>>(out, element.descriptor);
+	});
+
+	out += "],\"items\":false,\"minItems\":";
+	write_integer(out, member_count_v<std::remove_cvref_t<decltype(elements)>>);
+	out += '}';
+}
+
+template <typename T>
+constexpr void write_schema(std::string& out, const auto& descriptor)
+{
+	using TDesc = std::remove_cvref_t<decltype(descriptor)>;
+
+	if constexpr (is_optional_v<T>)
+	{
+		out += "{\"anyOf\":[";
+		write_schema<typename T::value_type>(out, descriptor);
+		out += ",{\"type\":\"null\"}]}";
+	}
+	else if constexpr (std::is_same_v<TDesc, boolean_t>)
+	{
+		out += "{\"type\":\"boolean\"}";
+	}
+	else if constexpr (std::is_same_v<TDesc, number_t>)
+	{
+		write_number_schema<T>(out);
+	}
+	else if constexpr (is_decimal_v<TDesc>)
+	{
+		write_decimal_schema(out, descriptor);
+	}
+	else if constexpr (std::is_same_v<TDesc, any_t>)
+	{
+		out += "{}";
+	}
+	else if constexpr (std::is_same_v<TDesc, string_t>)
+	{
+		out += "{\"type\":\"string\"";
+
+		// a char array keeps room for its terminator
+		if constexpr (std::is_same_v<T, char>)
+			out += ",\"maxLength\":1";
+		else if constexpr (std::is_bounded_array_v<T>)
+		{
+			out += ",\"maxLength\":";
+			write_integer(out, std::extent_v<T> - 1);
+		}
+
+		out += '}';
+	}
+	else if constexpr (is_field_list_v<TDesc>)
+	{
+		write_fields_schema<T>(out, descriptor);
+	}
+	else if constexpr (is_element_list_v<TDesc>)
+	{
+		write_elements_schema<T>(out, descriptor);
+	}
+	else if constexpr (is_pair_v<underlying_value_type_t<T>>)
+	{
+		// object descriptor
+		out += "{\"type\":\"object\",\"additionalProperties\":";
+		write_schema<typename underlying_value_type_t<T>::second_type>(out, descriptor.value_descriptor);
+		out += '}';
+	}
+	else
+	{
+		// array descriptor, items past a fixed size would be dropped
+		out += "{\"type\":\"array\",\"items\":";
+		write_schema<underlying_value_type_t<T>>(out, descriptor.value_descriptor);
+
+		if constexpr (schema_extent_v<T> != 0)
+		{
+			out += ",\"maxItems\":";
+			write_integer(out, schema_extent_v<T>);
+		}
+
+		out += '}';
+	}
+}
+}
+
+// the schema of a T described by descriptor, as a string
+template <typename T>
+constexpr std::string schema(const auto& descriptor)
+{
+	std::string out{ "{\"$schema\":\"https://json-schema.org/draft/2020-12/schema\"," };
+
+	// the value's own schema goes in the same object as $schema
+	std::string value;
+	detail::write_schema<T>(value, descriptor);
+
+	if (value == "{}")
+		out.pop_back();
+
+	out.append(value.begin() + 1, value.end());
+
+	return out;
+}
+
+namespace detail
+{
+template <typename T, const auto& Descriptor>
+struct static_schema
+{
+	static constexpr std::size_t size = schema<T>(Descriptor).size();
+
+	static constexpr std::array<char, size> data = []() {
+		std::array<char, size> data{};
+		const std::string text = schema<T>(Descriptor);
+		std::copy(text.begin(), text.end(), data.begin());
+		return data;
+	}();
+};
+}
+
+// the schema built at compile time, for descriptors declared constexpr at namespace scope
+template <typename T, const auto& Descriptor>
+constexpr std::string_view schema_v{ detail::static_schema<T, Descriptor>::data.data(), detail::static_schema<T, Descriptor>::size };
+
+} // json
+
+#endif // __JSON_SCHEMA_HPP
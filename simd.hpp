@@ -0,0 +1,359 @@
+#ifndef __JSON_SIMD_HPP
+#define __JSON_SIMD_HPP
+
+#include <atomic>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JSON_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace json
+{
+
+// Vectorised scanning kernels used by the parser and stringifier. The implementation is picked at
+// runtime from what the CPU supports, so a single binary runs everywhere, and can be forced for
+// benchmarking.
+namespace simd
+{
+
+enum class isa { scalar, sse2, avx2, avx512 };
+
+struct kernels
+{
+	isa id;
+	// first '"' or '\\' in [begin, end), or end
+	const char* (*find_quote_or_backslash)(const char* begin, const char* end);
+	// first character the stringifier has to look at before writing, or end
+	const char* (*find_escape)(const char* begin, const char* end);
+	// first '"', '[', ']', '{' or '}', or end
+	const char* (*find_structural)(const char* begin, const char* end);
+};
+
+inline bool is_escape(const char c)
+{
+	const auto u = static_cast<unsigned char>(c);
+	return u < 0x20 || u >= 0x7f || c == '"' || c == '\\' || c == '/';
+}
+
+inline const char* find_quote_or_backslash_scalar(const char* it, const char* const end)
+{
+	while (it != end && *it != '"' && *it != '\\')
+		++it;
+	return it;
+}
+
+inline const char* find_escape_scalar(const char* it, const char* const end)
+{
+	while (it != end && !is_escape(*it))
+		++it;
+	return it;
+}
+
+inline bool is_structural(const char c)
+{
+	return c == '"' || c == '[' || c == ']' || c == '{' || c == '}';
+}
+
+inline const char* find_structural_scalar(const char* it, const char* const end)
+{
+	while (it != end && !is_structural(*it))
+		++it;
+	return it;
+}
+
+inline constexpr kernels scalar_kernels{ isa::scalar, find_quote_or_backslash_scalar, find_escape_scalar, find_structural_scalar };
+
+#ifdef JSON_SIMD_X86
+
+__attribute__((target("sse2")))
+inline const char* find_quote_or_backslash_sse2(const char* it, const char* const end)
+{
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+
+	for (; end - it >= 16; it += 16)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		if (const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash))))
+			return it + __builtin_ctz(mask);
+	}
+
+	return find_quote_or_backslash_scalar(it, end);
+}
+
+// signed comparison against 0x20 also catches every byte >= 0x80
+__attribute__((target("sse2")))
+inline const char* find_escape_sse2(const char* it, const char* const end)
+{
+	const __m128i space = _mm_set1_epi8(0x20);
+	const __m128i del = _mm_set1_epi8(0x7f);
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i slash = _mm_set1_epi8('/');
+
+	for (; end - it >= 16; it += 16)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		const __m128i special = _mm_or_si128(
+			_mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpeq_epi8(v, del)),
+			_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)), _mm_cmpeq_epi8(v, slash)));
+
+		if (const int mask = _mm_movemask_epi8(special))
+			return it + __builtin_ctz(mask);
+	}
+
+	return find_escape_scalar(it, end);
+}
+
+// '[' ']' and '{' '}' only differ in bit 5, so masking it out leaves two comparisons
+__attribute__((target("sse2")))
+inline const char* find_structural_sse2(const char* it, const char* const end)
+{
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i case_bit = _mm_set1_epi8(~0x20);
+	const __m128i open = _mm_set1_epi8('[');
+	const __m128i close = _mm_set1_epi8(']');
+
+	for (; end - it >= 16; it += 16)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		const __m128i folded = _mm_and_si128(v, case_bit);
+		const __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+			_mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)));
+
+		if (const int mask = _mm_movemask_epi8(special))
+			return it + __builtin_ctz(mask);
+	}
+
+	return find_structural_scalar(it, end);
+}
+
+__attribute__((target("avx2")))
+inline const char* find_quote_or_backslash_avx2(const char* it, const char* const end)
+{
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+
+	for (; end - it >= 32; it += 32)
+	{
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+		if (const unsigned mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash))))
+			return it + __builtin_ctz(mask);
+	}
+
+	return find_quote_or_backslash_sse2(it, end);
+}
+
+__attribute__((target("avx2")))
+inline const char* find_escape_avx2(const char* it, const char* const end)
+{
+	const __m256i space = _mm256_set1_epi8(0x20);
+	const __m256i del = _mm256_set1_epi8(0x7f);
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i slash = _mm256_set1_epi8('/');
+
+	for (; end - it >= 32; it += 32)
+	{
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+		const __m256i special = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpgt_epi8(space, v), _mm256_cmpeq_epi8(v, del)),
+			_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)), _mm256_cmpeq_epi8(v, slash)));
+
+		if (const unsigned mask = _mm256_movemask_epi8(special))
+			return it + __builtin_ctz(mask);
+	}
+
+	return find_escape_sse2(it, end);
+}
+
+__attribute__((target("avx2")))
+inline const char* find_structural_avx2(const char* it, const char* const end)
+{
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i case_bit = _mm256_set1_epi8(~0x20);
+	const __m256i open = _mm256_set1_epi8('[');
+	const __m256i close = _mm256_set1_epi8(']');
+
+	for (; end - it >= 32; it += 32)
+	{
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+		const __m256i folded = _mm256_and_si256(v, case_bit);
+		const __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+			_mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)));
+
+		if (const unsigned mask = _mm256_movemask_epi8(special))
+			return it + __builtin_ctz(mask);
+	}
+
+	return find_structural_sse2(it, end);
+}
+
+__attribute__((target("avx512bw")))
+inline const char* find_quote_or_backslash_avx512(const char* it, const char* const end)
+{
+	const __m512i quote = _mm512_set1_epi8('"');
+	const __m512i backslash = _mm512_set1_epi8('\\');
+
+	for (; end - it >= 64; it += 64)
+	{
+		const __m512i v = _mm512_loadu_si512(it);
+		if (const __mmask64 mask = _mm512_cmpeq_epi8_mask(v, quote) | _mm512_cmpeq_epi8_mask(v, backslash))
+			return it + __builtin_ctzll(mask);
+	}
+
+	return find_quote_or_backslash_avx2(it, end);
+}
+
+__attribute__((target("avx512bw")))
+inline const char* find_escape_avx512(const char* it, const char* const end)
+{
+	const __m512i space = _mm512_set1_epi8(0x20);
+	const __m512i del = _mm512_set1_epi8(0x7f);
+	const __m512i quote = _mm512_set1_epi8('"');
+	const __m512i backslash = _mm512_set1_epi8('\\');
+	const __m512i slash = _mm512_set1_epi8('/');
+
+	for (; end - it >= 64; it += 64)
+	{
+		const __m512i v = _mm512_loadu_si512(it);
+		const __mmask64 mask = _mm512_cmplt_epi8_mask(v, space) | _mm512_cmpeq_epi8_mask(v, del)
+			| _mm512_cmpeq_epi8_mask(v, quote) | _mm512_cmpeq_epi8_mask(v, backslash) | _mm512_cmpeq_epi8_mask(v, slash);
+
+		if (mask)
+			return it + __builtin_ctzll(mask);
+	}
+
+	return find_escape_avx2(it, end);
+}
+
+__attribute__((target("avx512bw")))
+inline const char* find_structural_avx512(const char* it, const char* const end)
+{
+	const __m512i quote = _mm512_set1_epi8('"');
+	const __m512i case_bit = _mm512_set1_epi8(~0x20);
+	const __m512i open = _mm512_set1_epi8('[');
+	const __m512i close = _mm512_set1_epi8(']');
+
+	for (; end - it >= 64; it += 64)
+	{
+		const __m512i v = _mm512_loadu_si512(it);
+		const __m512i folded = _mm512_and_si512(v, case_bit);
+		const __mmask64 mask = _mm512_cmpeq_epi8_mask(v, quote)
+			| _mm512_cmpeq_epi8_mask(folded, open) | _mm512_cmpeq_epi8_mask(folded, close);
+
+		if (mask)
+			return it + __builtin_ctzll(mask);
+	}
+
+	return find_structural_avx2(it, end);
+}
+
+inline constexpr kernels sse2_kernels{ isa::sse2, find_quote_or_backslash_sse2, find_escape_sse2, find_structural_sse2 };
+inline constexpr kernels avx2_kernels{ isa::avx2, find_quote_or_backslash_avx2, find_escape_avx2, find_structural_avx2 };
+inline constexpr kernels avx512_kernels{ isa::avx512, find_quote_or_backslash_avx512, find_escape_avx512, find_structural_avx512 };
+
+#endif // JSON_SIMD_X86
+
+inline const kernels* kernels_for(const isa id)
+{
+	switch (id)
+	{
+#ifdef JSON_SIMD_X86
+	case isa::sse2: return &sse2_kernels;
+	case isa::avx2: return &avx2_kernels;
+	case isa::avx512: return &avx512_kernels;
+#endif
+	default: return &scalar_kernels;
+	}
+}
+
+inline bool supported(const isa id)
+{
+#ifdef JSON_SIMD_X86
+	__builtin_cpu_init();
+
+	switch (id)
+	{
+	case isa::scalar: return true;
+	case isa::sse2: return __builtin_cpu_supports("sse2");
+	case isa::avx2: return __builtin_cpu_supports("avx2");
+	case isa::avx512: return __builtin_cpu_supports("avx512bw");
+	}
+
+	return false;
+#else
+	return id == isa::scalar;
+#endif
+}
+
+inline isa best_supported()
+{
+	for (const isa id : { isa::avx512, isa::avx2, isa::sse2 })
+		if (supported(id))
+			return id;
+
+	return isa::scalar;
+}
+
+inline std::string_view name(const isa id)
+{
+	switch (id)
+	{
+	case isa::sse2: return "sse2";
+	case isa::avx2: return "avx2";
+	case isa::avx512: return "avx512";
+	default: return "scalar";
+	}
+}
+
+// selected on first use rather than during static initialisation, so it's usable from other initialisers
+inline std::atomic<const kernels*> active_kernels{ nullptr };
+
+inline const kernels& current()
+{
+	const kernels* k = active_kernels.load(std::memory_order_relaxed);
+
+	if (k == nullptr)
+	{
+		k = kernels_for(best_supported());
+		active_kernels.store(k, std::memory_order_relaxed);
+	}
+
+	return *k;
+}
+
+inline isa active() { return current().id; }
+
+// selects the implementation used from now on, returns false if the CPU doesn't support it
+inline bool force(const isa id)
+{
+	if (!supported(id))
+		return false;
+
+	active_kernels.store(kernels_for(id), std::memory_order_relaxed);
+	return true;
+}
+
+inline const char* find_quote_or_backslash(const char* begin, const char* end)
+{
+	return current().find_quote_or_backslash(begin, end);
+}
+
+inline const char* find_escape(const char* begin, const char* end)
+{
+	return current().find_escape(begin, end);
+}
+
+inline const char* find_structural(const char* begin, const char* end)
+{
+	return current().find_structural(begin, end);
+}
+
+} // simd
+
+} // json
+
+#endif // __JSON_SIMD_HPP
@@ -0,0 +1,160 @@
+#ifndef __JSON_SINK_HPP
+#define __JSON_SINK_HPP
+
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <type_traits>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define JSON_HAS_POSIX_IO
+#endif
+
+namespace json
+{
+
+// A buffer the stringifier can write to instead of a std::ostream. Derived classes decide what
+// happens to it when it fills up. Numbers are formatted the way a default std::ostream does.
+class sink
+{
+public:
+	sink() = default;
+	sink(const sink&) = delete;
+	sink& operator=(const sink&) = delete;
+	virtual ~sink() = default; // derived classes flush in their own destructors
+
+	sink& put(const char c)
+	{
+		if (pos == last)
+			flush_buffer();
+
+		*pos++ = c;
+		return *this;
+	}
+
+	sink& write(const char* s, std::size_t n)
+	{
+		while (n != 0)
+		{
+			if (pos == last)
+				flush_buffer();
+
+			const std::size_t count = std::min(n, static_cast<std::size_t>(last - pos));
+			std::memcpy(pos, s, count);
+			pos += count;
+			s += count;
+			n -= count;
+		}
+
+		return *this;
+	}
+
+	sink& operator<<(const char c) { return put(c); }
+	sink& operator<<(const signed char c) { return put(static_cast<char>(c)); }
+	sink& operator<<(const unsigned char c) { return put(static_cast<char>(c)); }
+	sink& operator<<(const char* s) { return write(s, std::strlen(s)); }
+	sink& operator<<(const std::string& s) { return write(s.data(), s.size()); }
+	sink& operator<<(const bool b) { return put(b ? '1' : '0'); }
+
+	template <typename T> requires (std::is_arithmetic_v<T>)
+	sink& operator<<(const T value)
+	{
+		char digits[64];
+		std::to_chars_result result;
+
+		if constexpr (std::is_floating_point_v<T>)
+			result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+		else
+			result = std::to_chars(digits, digits + sizeof(digits), value);
+
+		return write(digits, result.ptr - digits);
+	}
+
+	// passes everything written so far on
+	void flush()
+	{
+		if (pos != first)
+			flush_buffer();
+	}
+
+protected:
+	char* first{};
+	char* pos{};
+	char* last{};
+
+	void set_buffer(char* const buffer, const std::size_t size)
+	{
+		first = pos = buffer;
+		last = buffer + size;
+	}
+
+	// consumes [first, pos) and leaves room in the buffer
+	virtual void flush_buffer() = 0;
+};
+
+// Appends to a std::string.
+class string_sink : public sink
+{
+public:
+	explicit string_sink(std::string& out) : out{ out } { set_buffer(buffer, sizeof(buffer)); }
+
+	~string_sink() override { flush(); }
+
+protected:
+	void flush_buffer() override
+	{
+		out.append(first, pos);
+		pos = first;
+	}
+
+private:
+	std::string& out;
+	char buffer[1 << 12];
+};
+
+#ifdef JSON_HAS_POSIX_IO
+// Writes straight to a file descriptor with write(2) whenever its buffer fills.
+class fd_sink : public sink
+{
+public:
+	static constexpr std::size_t default_buffer_size = 1 << 20;
+
+	int error{}; // errno of the first failed write, after which output is dropped
+
+	explicit fd_sink(const int fd, const std::size_t buffer_size = default_buffer_size)
+		: fd{ fd }, buffer{ new char[buffer_size] }
+	{
+		set_buffer(buffer.get(), buffer_size);
+	}
+
+	~fd_sink() override { flush(); }
+
+	bool good() const { return error == 0; }
+
+protected:
+	void flush_buffer() override
+	{
+		for (const char* it = first; error == 0 && it != pos; )
+		{
+			if (const ssize_t n = ::write(fd, it, pos - it); n >= 0)
+				it += n;
+			else if (errno != EINTR)
+				error = errno;
+		}
+
+		pos = first;
+	}
+
+private:
+	int fd;
+	std::unique_ptr<char[]> buffer;
+};
+#endif
+
+} // json
+
+#endif // __JSON_SINK_HPP
@@ -3,12 +3,26 @@
 
 #include <sstream>
 #include <charconv>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <utility>
 
 #include "json.hpp"
+#include "reflection.hpp"
+#include "simd.hpp"
+#include "sink.hpp"
+#include "tape.hpp"
 
 namespace json
 {
 
+template <typename T, typename TFields> requires (is_field_list_v<TFields> && member_count_v<TFields> != 0)
+class tracked_value;
+
 namespace
 {
 template <typename T>
@@ -17,6 +31,28 @@ constexpr bool is_trivial_value_v = false;
 template <> constexpr bool is_trivial_value_v<boolean_t> = true;
 template <> constexpr bool is_trivial_value_v<number_t> = true;
 template <> constexpr bool is_trivial_value_v<string_t> = true;
+
+template <int Scale, rounding Rounding>
+constexpr bool is_trivial_value_v<decimal_t<Scale, Rounding>> = true;
+
+template <const auto& Root, std::size_t... Steps>
+constexpr bool is_trivial_value_v<static_descriptor<Root, Steps...>> = is_trivial_value_v<std::remove_cvref_t<decltype(static_descriptor<Root, Steps...>::value)>>;
+
+// holds up to Inline values in place, more than that on the heap
+template <typename T, std::size_t Inline = 32>
+class small_buffer
+{
+public:
+	explicit small_buffer(const std::size_t size) : count{ size }, heap{ size > Inline ? std::make_unique<T[]>(size) : nullptr } {}
+
+	T* begin() { return heap ? heap.get() : local; }
+	T* end() { return begin() + count; }
+
+private:
+	T local[Inline];
+	std::size_t count;
+	std::unique_ptr<T[]> heap;
+};
 }
 
 struct stringifier
@@ -24,32 +60,116 @@ struct stringifier
 public:
 	bool dense{}; // removes spacing around elements in arrays and objects
 	bool pretty{}; // adds newlines to arrays or objects containing arrays or objects
+	bool canonical{}; // writes RFC 8785 canonical json, overrides dense and pretty
+	bool sorted{}; // writes the entries of unordered maps in key order, like canonical does
 
 	std::string operator()(const auto& value, const auto& descriptor)
 	{
-		indent = 0;
 		std::stringstream ss;
-		stringify(ss, value, descriptor);
+		start(ss, value, descriptor);
 		return ss.str();
 	}
 
 	void operator()(std::ostream& os, const auto& value, const auto& descriptor)
 	{
-		indent = 0;
-		stringify(os, value, descriptor);
+		start(os, value, descriptor);
+	}
+
+	// writes without going through iostreams, call os.flush() once done if the sink outlives the call
+	void operator()(sink& os, const auto& value, const auto& descriptor)
+	{
+		start(os, value, descriptor);
+	}
+
+	// the same for descriptors declared constexpr with static storage, whose field lists canonical
+	// output writes in an order sorted at compile time
+	template <const auto& Descriptor>
+	std::string operator()(const auto& value)
+	{
+		return (*this)(value, static_descriptor<Descriptor>{});
+	}
+
+	template <const auto& Descriptor>
+	void operator()(std::ostream& os, const auto& value)
+	{
+		start(os, value, static_descriptor<Descriptor>{});
+	}
+
+	template <const auto& Descriptor>
+	void operator()(sink& os, const auto& value)
+	{
+		start(os, value, static_descriptor<Descriptor>{});
 	}
 
 private:
 	int indent{};
 
-	inline void do_indent(std::ostream& os)
+	void start(auto& os, const auto& value, const auto& descriptor)
+	{
+		indent = 0;
+
+		if (canonical)
+		{
+			const bool was_dense = std::exchange(dense, true);
+			const bool was_pretty = std::exchange(pretty, false);
+			stringify(os, value, descriptor);
+			dense = was_dense;
+			pretty = was_pretty;
+		}
+		else
+		{
+			stringify(os, value, descriptor);
+		}
+	}
+
+	// the order RFC 8785 sorts keys in, by their UTF-16 code units. That's the order of their UTF-8
+	// bytes, except that characters past U+FFFF come before U+E000 to U+FFFF.
+	static constexpr bool key_less(const std::string_view a, const std::string_view b)
+	{
+		const auto [x, y] = std::ranges::mismatch(a, b);
+
+		if (y == b.end())
+			return false;
+
+		if (x == a.end())
+			return true;
+
+		const auto first = static_cast<unsigned char>(*x);
+		const auto second = static_cast<unsigned char>(*y);
+
+		if (first >= 0xf0 && (second == 0xee || second == 0xef))
+			return true;
+
+		if (second >= 0xf0 && (first == 0xee || first == 0xef))
+			return false;
+
+		return first < second;
+	}
+
+	template <typename T>
+	static constexpr bool is_sorted_map_v = requires { requires std::is_same_v<typename T::key_compare, std::less<>> || std::is_same_v<typename T::key_compare, std::less<typename T::key_type>>; };
+
+	template <typename T>
+	static std::string_view text_view(const T& text)
+	{
+		if constexpr (std::is_same_v<T, char>)
+			return std::string_view{ &text, 1 };
+		else if constexpr (std::is_same_v<T, const char*>)
+			return std::string_view{ text };
+		else if constexpr (std::is_bounded_array_v<T>)
+			return std::string_view{ text, static_cast<std::size_t>(std::find(text, text + std::extent_v<T>, '\0') - text) };
+		else
+			return std::string_view{ std::ranges::data(text), std::ranges::size(text) };
+	}
+
+	inline void do_indent(auto& os)
 	{
 		for (int i = 0; i < indent; ++i)
 			os << '\t';
 	}
 
 	template <typename T, Descriptor TDesc>
-	void stringify(std::ostream& os, const std::optional<T>& value, const TDesc& desc)
+	void stringify(auto& os, const std::optional<T>& value, const TDesc& desc)
 	{
 		if (value)
 		{
@@ -61,18 +181,260 @@ private:
 		}
 	}
 
-	void stringify(std::ostream& os, const Boolean auto& value, const boolean_t&)
+	template <Boolean T> requires (Mandatory<T>)
+	void stringify(auto& os, const T& value, const boolean_t&)
 	{
 		os << (value ? literals::true_ : literals::false_);
 	}
 
-	void stringify(std::ostream& os, const Number auto& value, const number_t&)
+	void stringify(auto& os, const Number auto& value, const number_t&)
+	{
+		if (canonical)
+		{
+			stringify_canonical(os, value);
+		}
+		else
+		{
+			os << value;
+		}
+	}
+
+	// written as it was parsed. Text that isn't a json number is written as null even for members that
+	// aren't optional, which keeps the output valid json but won't parse back into them.
+	void stringify(auto& os, const NumberText auto& value, const number_t&)
+	{
+		if (const std::string_view text = text_view(value); text.empty() || detail::scan_number(text.data(), text.data() + text.size()) != text.data() + text.size())
+		{
+			os << literals::null;
+		}
+		else
+		{
+			stringify_number_text(os, text);
+		}
+	}
+
+	// canonical output writes the number's value instead, null past the largest double like infinities
+	// and 0 below the smallest
+	void stringify_number_text(auto& os, const std::string_view text)
 	{
-		os << value;
+		double number{};
+
+		if (!canonical)
+		{
+			os.write(text.data(), text.size());
+		}
+		else if (const std::errc ec = std::from_chars(text.data(), text.data() + text.size(), number).ec; ec == std::errc{})
+		{
+			stringify_canonical(os, number);
+		}
+		else if (ec == std::errc::result_out_of_range)
+		{
+			if (overflows(text))
+				os << literals::null;
+			else
+				os << '0';
+		}
+		else
+		{
+			os.write(text.data(), text.size());
+		}
+	}
+
+	// whether a number too far from 1 for a double is too large rather than too small, by the power of
+	// ten of its first significant digit
+	static bool overflows(const std::string_view text)
+	{
+		auto it = text.begin();
+		long long power = -1;
+		bool significant = false;
+
+		if (it != text.end() && *it == '-')
+			it++;
+
+		for (; it != text.end() && *it >= '0' && *it <= '9'; ++it)
+		{
+			significant |= *it != '0';
+			power += significant;
+		}
+
+		if (it != text.end() && *it == '.')
+		{
+			for (++it; it != text.end() && *it >= '0' && *it <= '9' && !significant; ++it)
+			{
+				significant = *it != '0';
+				power -= !significant;
+			}
+
+			it = std::find_if(it, text.end(), [](const char c) { return c == 'e' || c == 'E'; });
+		}
+
+		if (it != text.end() && (*it == 'e' || *it == 'E'))
+		{
+			++it;
+			const bool negative = it != text.end() && *it == '-';
+
+			if (it != text.end() && (*it == '-' || *it == '+'))
+				++it;
+
+			long long exponent = 0;
+			for (; it != text.end() && *it >= '0' && *it <= '9'; ++it)
+				exponent = std::min(exponent * 10 + (*it - '0'), 1ll << 40);
+
+			power += negative ? -exponent : exponent;
+		}
+
+		return power > 0;
+	}
+
+	// integers as they are, anything else in its shortest round trip form, written the way ECMAScript
+	// writes numbers: with an exponent only below 1e-6 or from 1e21 on
+	template <Number T>
+	void stringify_canonical(auto& os, const T value)
+	{
+		char buffer[64];
+
+		if constexpr (std::is_integral_v<T>)
+		{
+			using wide_t = std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>;
+
+			const unsigned long long magnitude = value < 0 ? 0 - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+
+			// past 2^53 the value is the double nearest to it, as other implementations read it
+			if (magnitude > 1ull << 53)
+			{
+				stringify_canonical(os, static_cast<double>(value));
+				return;
+			}
+
+			os.write(buffer, std::to_chars(buffer, buffer + sizeof(buffer), static_cast<wide_t>(value)).ptr - buffer);
+		}
+		else
+		{
+			if (!std::isfinite(value))
+			{
+				os << literals::null;
+				return;
+			}
+
+			if (value == 0)
+			{
+				os << '0';
+				return;
+			}
+
+			// d[.ddd]e[+-]dd
+			const char* const end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific).ptr;
+			const char* it = buffer;
+
+			if (*it == '-')
+			{
+				os << '-';
+				it++;
+			}
+
+			char digits[64];
+			int count{};
+
+			for (; *it != 'e'; ++it)
+			{
+				if (*it != '.')
+					digits[count++] = *it;
+			}
+
+			int exponent{};
+			std::from_chars(it + (it[1] == '+' ? 2 : 1), end, exponent);
+
+			stringify_digits(os, digits, count, exponent + 1, false);
+		}
+	}
+
+	// count digits without trailing zeros, point of which come before the decimal point, with an
+	// exponent only where ECMAScript would use one unless plain
+	void stringify_digits(auto& os, const char* const digits, const int count, const int point, const bool plain)
+	{
+		if (count <= point && (plain || point <= 21))
+		{
+			os.write(digits, count);
+
+			for (int i = count; i < point; ++i)
+				os << '0';
+		}
+		else if (0 < point && (plain || point <= 21))
+		{
+			os.write(digits, point);
+			os << '.';
+			os.write(digits + point, count - point);
+		}
+		else if (point <= 0 && (plain || -6 < point))
+		{
+			os << '0' << '.';
+
+			for (int i = point; i < 0; ++i)
+				os << '0';
+
+			os.write(digits, count);
+		}
+		else
+		{
+			os << digits[0];
+
+			if (count > 1)
+			{
+				os << '.';
+				os.write(digits + 1, count - 1);
+			}
+
+			const int exponent = point - 1;
+			char buffer[16];
+
+			os << 'e' << (exponent < 0 ? '-' : '+');
+			os.write(buffer, std::to_chars(buffer, buffer + sizeof(buffer), exponent < 0 ? -exponent : exponent).ptr - buffer);
+		}
+	}
+
+	// exactly the integer's digits with the decimal point put back in
+	template <std::integral T, int Scale, rounding Rounding> requires (!std::is_same_v<T, bool>)
+	void stringify(auto& os, const T& value, const decimal_t<Scale, Rounding>&)
+	{
+		const std::uint64_t magnitude = value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+
+		if (magnitude == 0)
+		{
+			os << '0';
+			return;
+		}
+
+		char digits[32];
+		const int count = static_cast<int>(std::to_chars(digits, digits + sizeof(digits), magnitude).ptr - digits);
+		int significant = count;
+
+		while (digits[significant - 1] == '0')
+			significant--;
+
+		// a double only keeps 15 digits for sure, past that canonical output writes the double nearest
+		if (canonical && significant > 15)
+		{
+			digits[count] = 'e';
+			const char* const end = std::to_chars(digits + count + 1, digits + sizeof(digits), -Scale).ptr;
+
+			double number{};
+			std::from_chars(digits, end, number);
+			stringify_canonical(os, value < 0 ? -number : number);
+			return;
+		}
+
+		if (value < 0)
+			os << '-';
+
+		stringify_digits(os, digits, significant, count - Scale, !canonical);
 	}
 
 	inline bool needs_escaping(const char& c, char& escapee)
 	{
+		// canonical json only escapes what it has to
+		if (canonical && c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20)
+			return false;
+
 		switch (c)
 		{
 		case '\"':  escapee = '"';  return true;
@@ -93,7 +455,7 @@ private:
 		}
 	}
 
-	inline void stringify_string(std::ostream& os, const char c)
+	inline void stringify_string(auto& os, const char c)
 	{
 		if (char escapee{}; needs_escaping(c, escapee))
 		{
@@ -102,7 +464,7 @@ private:
 			if (escapee == 'u')
 			{
 				char xdigits[5]{};
-				std::to_chars(xdigits, xdigits + 5, 0x10000u | c, 16);
+				std::to_chars(xdigits, xdigits + 5, 0x10000u | static_cast<unsigned char>(c), 16);
 				os.write(xdigits + 1, 4);
 			}
 		}
@@ -112,28 +474,46 @@ private:
 		}
 	}
 
-	inline void stringify_string(std::ostream& os, const char* value)
+	// writes runs that need no escaping in one go
+	inline void stringify_string(auto& os, const char* it, const char* const end)
 	{
-		for (; *value != '\0'; ++value)
-			stringify_string(os, *value);
+		while (it != end)
+		{
+			const char* const run_end = simd::find_escape(it, end);
+			os.write(it, run_end - it);
+
+			if (run_end == end)
+				break;
+
+			stringify_string(os, *run_end);
+			it = run_end + 1;
+		}
+	}
+
+	inline void stringify_string(auto& os, const char* value)
+	{
+		stringify_string(os, value, value + std::strlen(value));
 	}
 
 	template <typename T> requires (!std::is_same_v<T, char>)
-	void stringify_string(std::ostream& os, const T& value)
+	void stringify_string(auto& os, const T& value)
 	{
-		for (const char& c : value)
+		if constexpr (std::is_bounded_array_v<T>)
 		{
-			if constexpr (std::is_bounded_array_v<T>)
-			{
-				if (c == '\0')
-					break;
-			}
-
-			stringify_string(os, c);
+			stringify_string(os, value, std::find(value, value + std::extent_v<T>, '\0'));
+		}
+		else if constexpr (std::ranges::contiguous_range<T>)
+		{
+			stringify_string(os, std::ranges::data(value), std::ranges::data(value) + std::ranges::size(value));
+		}
+		else
+		{
+			for (const char& c : value)
+				stringify_string(os, c);
 		}
 	}
 	
-	void stringify(std::ostream& os, const String auto& value, const string_t&)
+	void stringify(auto& os, const String auto& value, const string_t&)
 	{
 		os << '"';
 		stringify_string(os, value);
@@ -142,7 +522,7 @@ private:
 
 	// only newline non-trivial value types
 	template <typename TValue>
-	void stringify(std::ostream& os, const Array auto& values, const array<TValue>& descriptor)
+	void stringify(auto& os, const Array auto& values, const array<TValue>& descriptor)
 	{
 		os << '[';
 
@@ -225,7 +605,7 @@ private:
 	}
 
 	template <typename TValue, Descriptor TValueDesc>
-	void stringify_key_pair_value(std::ostream& os, const String auto& key, const TValue& value, const TValueDesc& value_descriptor)
+	void stringify_key_pair_value(auto& os, const String auto& key, const TValue& value, const TValueDesc& value_descriptor)
 	{
 		stringify(os, key, string);
 
@@ -240,7 +620,7 @@ private:
 	}
 
 	template <Descriptor TValue>
-	void stringify(std::ostream& os, const auto& values, const object<TValue>& descriptor)
+	void stringify(auto& os, const auto& values, const object<TValue>& descriptor)
 	{
 		os << '{';
 
@@ -270,8 +650,7 @@ private:
 
 		bool first = true;
 
-		for (const auto& [key, value] : values)
-		{
+		const auto stringify_entry = [&](const auto& key, const auto& value) {
 			if (!first)
 			{
 				os << ',';
@@ -299,6 +678,24 @@ private:
 
 			stringify_key_pair_value(os, key, value, descriptor.value_descriptor);
 			first = false;
+		};
+
+		// sorts pointers to the entries rather than copying them, maps ordered by std::less already are
+		if (canonical || (sorted && !is_sorted_map_v<std::remove_cvref_t<decltype(values)>>))
+		{
+			using entry_t = std::ranges::range_value_t<decltype(values)>;
+
+			small_buffer<const entry_t*> entries{ std::ranges::size(values) };
+			std::ranges::transform(values, entries.begin(), [](const entry_t& entry) { return &entry; });
+			std::ranges::sort(entries, [](const entry_t* a, const entry_t* b) { return key_less(text_view(a->first), text_view(b->first)); });
+
+			for (const entry_t* entry : entries)
+				stringify_entry(entry->first, entry->second);
+		}
+		else
+		{
+			for (const auto& [key, value] : values)
+				stringify_entry(key, value);
 		}
 
 		if constexpr (is_trivial_value_v<TValue>)
@@ -323,7 +720,7 @@ private:
 	}
 
 	template <int Index, typename T, typename TFields> requires (is_field_list_v<TFields>)
-	void stringify_fields(std::ostream& os, const T& value, const TFields& fields)
+	void stringify_fields(auto& os, const T& value, const TFields& fields)
 	{
 		const auto& field = std::get<Index>(fields);
 		const auto& member_ptr = field.member_ptr;
@@ -332,61 +729,432 @@ private:
 
 		if constexpr (Index + 1 < std::tuple_size_v<TFields>)
 		{
-			os << ',';
+			stringify_field_separator(os);
+			stringify_fields<Index + 1>(os, value, fields);
+		}
+	}
 
-			if (pretty)
+	void stringify_field_separator(auto& os)
+	{
+		os << ',';
+
+		if (pretty)
+		{
+			os << '\n';
+			do_indent(os);
+		}
+		else if (!dense)
+		{
+			os << ' ';
+		}
+	}
+
+	void open_fields(auto& os)
+	{
+		os << '{';
+
+		if (pretty)
+		{
+			os << '\n';
+
+			indent++;
+			do_indent(os);
+		}
+		else if (!dense)
+		{
+			os << ' ';
+		}
+	}
+
+	void close_fields(auto& os)
+	{
+		if (pretty)
+		{
+			os << '\n';
+
+			indent--;
+			do_indent(os);
+		}
+		else if (!dense)
+		{
+			os << ' ';
+		}
+			
+		os << '}';
+	}
+
+	template <typename T, typename TFields> requires (is_field_list_v<TFields>)
+	void stringify(auto& os, const T& value, const TFields& fields)
+	{
+		if constexpr (std::tuple_size_v<TFields> != 0)
+		{
+			open_fields(os);
+
+			if (canonical)
 			{
-				os << '\n';
-				do_indent(os);
+				stringify_sorted_fields(os, value, fields);
 			}
-			else if (!dense)
+			else
 			{
-				os << ' ';
+				stringify_fields<0>(os, value, fields);
 			}
+		}
+		else
+		{
+			os << '{';
+		}
 
-			stringify_fields<Index + 1>(os, value, fields);
+		close_fields(os);
+	}
+
+	// lists are short, so their names are sorted on the spot and the fields written through a table of
+	// one function per field. Descriptors given as template arguments have theirs sorted at compile time.
+	template <typename T, typename TFields>
+	void stringify_sorted_fields(auto& os, const T& value, const TFields& fields)
+	{
+		constexpr std::size_t count = member_count_v<TFields>;
+		using writer_t = void (*)(stringifier&, decltype(os), const T&, const TFields&);
+
+		static constexpr std::array<writer_t, count> writers = []<std::size_t... Indices>(std::index_sequence<Indices...>) {
+			return std::array<writer_t, count>{ [](stringifier& self, decltype(os) out, const T& value, const TFields& fields) {
+				const auto& field = std::get<Indices>(fields);
+				self.stringify_key_pair_value(out, field.name, value.*field.member_ptr, field.descriptor);
+			}... };
+		}(std::make_index_sequence<count>{});
+
+		std::array<std::string_view, count> names;
+		std::array<std::size_t, count> order;
+		std::size_t index{};
+
+		for_each_member(fields, [&](const auto& field) {
+			names[index] = field.name;
+			order[index] = index;
+			index++;
+		});
+
+		std::ranges::sort(order, [&](const std::size_t a, const std::size_t b) { return key_less(names[a], names[b]); });
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (i != 0)
+				stringify_field_separator(os);
+
+			writers[order[i]](*this, os, value, fields);
 		}
 	}
 
-	template <typename T, typename TFields> requires (is_field_list_v<TFields>)
-	void stringify(std::ostream& os, const T& value, const TFields& fields)
+	// Descriptors known at compile time only differ from others in canonical output, where field lists
+	// are written in an order the compiler sorted and their fields are unrolled in it.
+	template <typename T, const auto& Root, std::size_t... Steps> requires (Mandatory<T>)
+	void stringify(auto& os, const T& value, const static_descriptor<Root, Steps...>&)
 	{
-		os << '{';
-			
-		if constexpr (std::tuple_size_v<TFields> != 0)
+		using at = static_descriptor<Root, Steps...>;
+		using TDesc = std::remove_cvref_t<decltype(at::value)>;
+
+		if (!canonical)
 		{
-			if (pretty)
+			stringify(os, value, at::value);
+		}
+		else if constexpr (detail::is_array_descriptor_v<TDesc>)
+		{
+			stringify(os, value, array{ typename at::template child<0>{} });
+		}
+		else if constexpr (detail::is_object_descriptor_v<TDesc>)
+		{
+			stringify(os, value, object{ typename at::template child<0>{} });
+		}
+		else if constexpr (is_field_list_v<TDesc> && requires { value.*std::get<0>(at::value).member_ptr; })
+		{
+			stringify_static_fields<at>(os, value);
+		}
+		else if constexpr (is_element_list_v<TDesc>)
+		{
+			os << '[';
+
+			[&]<std::size_t... Indices>(std::index_sequence<Indices...>) {
+				((os << (Indices == 0 ? "" : ","), stringify(os, value.*std::get<Indices>(at::value).member_ptr, typename at::template child<Indices>{})), ...);
+			}(std::make_index_sequence<member_count_v<TDesc>>{});
+
+			os << ']';
+		}
+		else
+		{
+			stringify(os, value, at::value);
+		}
+	}
+
+	template <typename TStatic>
+	void stringify_static_fields(auto& os, const auto& value)
+	{
+		constexpr auto& fields = TStatic::value;
+		constexpr std::size_t count = member_count_v<std::remove_cvref_t<decltype(fields)>>;
+
+		static constexpr std::array<std::size_t, count> order = []() {
+			std::array<std::string_view, count> names;
+			std::array<std::size_t, count> order;
+			std::size_t index{};
+
+			for_each_member(fields, [&](const auto& field) {
+				names[index] = field.name;
+				order[index] = index;
+				index++;
+			});
+
+			std::ranges::sort(order, [&](const std::size_t a, const std::size_t b) { return key_less(names[a], names[b]); });
+			return order;
+		}();
+
+		open_fields(os);
+
+		[&]<std::size_t... Positions>(std::index_sequence<Positions...>) {
+			(stringify_static_field<TStatic, order[Positions]>(os, value, Positions != 0), ...);
+		}(std::make_index_sequence<count>{});
+
+		close_fields(os);
+	}
+
+	template <typename TStatic, std::size_t Index>
+	void stringify_static_field(auto& os, const auto& value, const bool separated)
+	{
+		const auto& field = std::get<Index>(TStatic::value);
+
+		if (separated)
+			stringify_field_separator(os);
+
+		stringify_key_pair_value(os, field.name, value.*field.member_ptr, typename TStatic::template child<Index>{});
+	}
+
+	// only stringifies the fields that changed since last time, the others are spliced in as they were
+	template <typename T, typename TFields>
+	void stringify(auto& os, const tracked_value<T, TFields>& value, const TFields& fields)
+	{
+		// the cache splices fields in declaration order
+		if (canonical)
+		{
+			stringify(os, value.current, fields);
+			return;
+		}
+
+		auto& cache = value.cache;
+
+		// pretty output depends on how deep the object is
+		if (const std::int64_t format = (dense ? 1 : 0) | (pretty ? 2 : 0) | (sorted ? 4 : 0) | static_cast<std::int64_t>(indent) << 3; format != cache.format)
+		{
+			cache.dirty.set();
+			cache.format = format;
+		}
+
+		open_fields(os);
+
+		std::size_t index{};
+
+		for_each_member(fields, [&](const auto& field) {
+			if (index != 0)
+				stringify_field_separator(os);
+
+			std::string& text = cache.values[index];
+
+			if (cache.dirty[index])
 			{
-				os << '\n';
+				text.clear();
+				string_sink fragment{ text };
+				stringify(static_cast<sink&>(fragment), value.current.*field.member_ptr, field.descriptor);
+			}
 
-				indent++;
-				do_indent(os);
+			stringify(os, field.name, string);
+			os << ':';
+
+			if (!dense)
+			{
+				os << ' ';
 			}
-			else if (!dense)
+
+			os.write(text.data(), text.size());
+			index++;
+		});
+
+		cache.dirty.reset();
+		close_fields(os);
+	}
+
+	// numbers are written back as they were parsed, objects are spaced like field lists
+	void stringify(auto& os, const tape& value, const any_t&)
+	{
+		if (value.empty())
+		{
+			os << literals::null;
+		}
+		else
+		{
+			stringify_tape(os, value, 0);
+		}
+	}
+
+	// returns the index after the value
+	std::size_t stringify_tape(auto& os, const tape& value, const std::size_t index)
+	{
+		switch (value.tag_at(index))
+		{
+		case tape::true_tag:
+			os << literals::true_;
+			return index + 1;
+		case tape::false_tag:
+			os << literals::false_;
+			return index + 1;
+		case tape::number_tag:
+			stringify_number_text(os, value.text_at(index));
+			return index + 2;
+		case tape::string_tag: {
+			const std::string_view text = value.text_at(index);
+			os << '"';
+			stringify_string(os, text.data(), text.data() + text.size());
+			os << '"';
+			return index + 2;
+		}
+		case tape::array_tag:
+			return stringify_tape_array(os, value, index);
+		case tape::object_tag:
+			return stringify_tape_object(os, value, index);
+		default:
+			os << literals::null;
+			return index + 1;
+		}
+	}
+
+	// arrays without containers in them are spaced like arrays of trivial values
+	std::size_t stringify_tape_array(auto& os, const tape& value, const std::size_t index)
+	{
+		const std::size_t first = index + 2;
+		const std::size_t end = value.next(index);
+
+		os << '[';
+
+		if (first == end)
+		{
+			os << ']';
+			return end;
+		}
+
+		bool trivial = true;
+
+		for (std::size_t i = first; trivial && i != end; i = value.next(i))
+			trivial = value.tag_at(i) != tape::array_tag && value.tag_at(i) != tape::object_tag;
+
+		if (trivial)
+		{
+			if (!dense)
 			{
 				os << ' ';
 			}
+		}
+		else if (pretty)
+		{
+			os << '\n';
 
-			stringify_fields<0>(os, value, fields);
+			indent++;
+			do_indent(os);
 		}
 
-		if (pretty)
+		for (std::size_t i = first; i != end; )
+		{
+			if (i != first)
+			{
+				os << ',';
+
+				if (pretty && !trivial)
+				{
+					os << '\n';
+					do_indent(os);
+				}
+				else if (!dense)
+				{
+					os << ' ';
+				}
+			}
+
+			i = stringify_tape(os, value, i);
+		}
+
+		if (trivial)
+		{
+			if (!dense)
+			{
+				os << ' ';
+			}
+		}
+		else if (pretty)
 		{
 			os << '\n';
 
 			indent--;
 			do_indent(os);
 		}
-		else if (!dense)
+
+		os << ']';
+		return end;
+	}
+
+	std::size_t stringify_tape_object(auto& os, const tape& value, const std::size_t index)
+	{
+		const std::size_t first = index + 2;
+		const std::size_t end = value.next(index);
+
+		if (first == end)
+		{
+			os << "{}";
+			return end;
+		}
+
+		open_fields(os);
+
+		if (canonical)
+		{
+			small_buffer<std::size_t> keys{ static_cast<std::size_t>(value.words[index + 1]) };
+			std::size_t* key = keys.begin();
+
+			for (std::size_t i = first; i != end; i = value.next(i + 2))
+				*key++ = i;
+
+			std::ranges::sort(keys, [&](const std::size_t a, const std::size_t b) { return key_less(value.text_at(a), value.text_at(b)); });
+
+			for (const std::size_t i : keys)
+			{
+				if (i != *keys.begin())
+					stringify_field_separator(os);
+
+				stringify_tape_member(os, value, i);
+			}
+		}
+		else
+		{
+			for (std::size_t i = first; i != end; )
+			{
+				if (i != first)
+					stringify_field_separator(os);
+
+				i = stringify_tape_member(os, value, i);
+			}
+		}
+
+		close_fields(os);
+		return end;
+	}
+
+	std::size_t stringify_tape_member(auto& os, const tape& value, std::size_t index)
+	{
+		index = stringify_tape(os, value, index);
+		os << ':';
+
+		if (!dense)
 		{
 			os << ' ';
 		}
-			
-		os << '}';
+
+		return stringify_tape(os, value, index);
 	}
 
 	template <int Index, typename TElements> requires (is_element_list_v<TElements>)
-	void stringify_elements(std::ostream& os, const auto& value, const TElements& elements)
+	void stringify_elements(auto& os, const auto& value, const TElements& elements)
 	{
 		const auto& element = std::get<Index>(elements);
 		const auto& member_ptr = element.member_ptr;
@@ -403,7 +1171,7 @@ private:
 	}
 
 	template <typename TElements> requires (is_element_list_v<TElements>)
-	void stringify(std::ostream& os, const auto& value, const TElements& elements)
+	void stringify(auto& os, const auto& value, const TElements& elements)
 	{
 		os << '[';
 
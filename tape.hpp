@@ -0,0 +1,280 @@
+#ifndef __JSON_TAPE_HPP
+#define __JSON_TAPE_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+
+namespace json
+{
+
+// Holds a json value of any shape, parsed with the json::any descriptor, as a flat array of tagged
+// 64-bit words next to one buffer for the text of strings and numbers. A container's first word says
+// where it ends, so its members are skipped over in one step. Numbers are kept as they were written,
+// so they're stringified back exactly. Parsing into the same tape again reuses its memory.
+class tape
+{
+public:
+	enum class kind : std::uint8_t
+	{
+		null,
+		boolean,
+		number,
+		string,
+		array,
+		object,
+	};
+
+	class value;
+
+	// the whole value, null if nothing was parsed
+	value root() const;
+
+	bool empty() const { return words.empty(); }
+
+	void clear()
+	{
+		words.clear();
+		text.clear();
+	}
+
+	// the same json, written the same way
+	bool operator==(const tape&) const = default;
+
+private:
+	friend struct parser;
+	friend struct stringifier;
+
+	// the tag takes the top byte, the rest is an offset into text, or for containers the index of the
+	// word after their last member. Strings and numbers are followed by their length, containers by
+	// their number of members.
+	enum tag : std::uint64_t
+	{
+		null_tag = std::uint64_t{ 'n' } << 56,
+		true_tag = std::uint64_t{ 't' } << 56,
+		false_tag = std::uint64_t{ 'f' } << 56,
+		number_tag = std::uint64_t{ 'd' } << 56,
+		string_tag = std::uint64_t{ '"' } << 56,
+		array_tag = std::uint64_t{ '[' } << 56,
+		object_tag = std::uint64_t{ '{' } << 56,
+	};
+
+	static constexpr std::uint64_t tag_mask = std::uint64_t{ 0xff } << 56;
+
+	std::vector<std::uint64_t> words;
+	std::string text;
+
+	std::uint64_t tag_at(const std::size_t index) const { return words[index] & tag_mask; }
+
+	std::uint64_t payload_at(const std::size_t index) const { return words[index] & ~tag_mask; }
+
+	// the index after the value at index
+	std::size_t next(const std::size_t index) const
+	{
+		switch (tag_at(index))
+		{
+		case number_tag:
+		case string_tag:
+			return index + 2;
+		case array_tag:
+		case object_tag:
+			return static_cast<std::size_t>(payload_at(index));
+		default:
+			return index + 1;
+		}
+	}
+
+	std::string_view text_at(const std::size_t index) const
+	{
+		return std::string_view{ text }.substr(static_cast<std::size_t>(payload_at(index)), static_cast<std::size_t>(words[index + 1]));
+	}
+
+	std::size_t push_text(const std::uint64_t tag, const std::size_t offset)
+	{
+		words.push_back(tag | offset);
+		words.push_back(text.size() - offset);
+		return words.size();
+	}
+
+	std::size_t open(const std::uint64_t tag)
+	{
+		words.push_back(tag);
+		words.push_back(0);
+		return words.size() - 2;
+	}
+
+	void close(const std::size_t start, const std::uint64_t count)
+	{
+		words[start] |= words.size();
+		words[start + 1] = count;
+	}
+};
+
+// Where a value sits in a tape, valid as long as the tape isn't parsed into again.
+class tape::value
+{
+public:
+	class iterator;
+
+	value(const tape& t, const std::size_t index) : t{ &t }, index{ index } {}
+
+	kind type() const
+	{
+		if (t->empty())
+			return kind::null;
+
+		switch (t->tag_at(index))
+		{
+		case true_tag:
+		case false_tag:
+			return kind::boolean;
+		case number_tag:
+			return kind::number;
+		case string_tag:
+			return kind::string;
+		case array_tag:
+			return kind::array;
+		case object_tag:
+			return kind::object;
+		default:
+			return kind::null;
+		}
+	}
+
+	bool is_null() const { return type() == kind::null; }
+
+	// false unless it is true
+	bool as_bool() const { return !t->empty() && t->tag_at(index) == true_tag; }
+
+	// a number's text as written, or a string's decoded contents, empty for anything else
+	std::string_view as_string() const
+	{
+		const kind k = type();
+		return k == kind::number || k == kind::string ? t->text_at(index) : std::string_view{};
+	}
+
+	// the number converted to T, if it is a number that fits
+	template <typename T>
+	std::optional<T> as_number() const
+	{
+		if (type() != kind::number)
+			return std::nullopt;
+
+		const std::string_view number = t->text_at(index);
+		T result{};
+
+		if (const auto [end, ec] = std::from_chars(number.data(), number.data() + number.size(), result); ec != std::errc{} || end != number.data() + number.size())
+			return std::nullopt;
+
+		return result;
+	}
+
+	// the number of elements or members of a container, 0 for anything else
+	std::size_t size() const
+	{
+		const kind k = type();
+		return k == kind::array || k == kind::object ? static_cast<std::size_t>(t->words[index + 1]) : 0;
+	}
+
+	iterator begin() const;
+	iterator end() const;
+
+	// the element at position n of an array, skipping over the ones before it, or nothing
+	std::optional<value> operator[](std::size_t n) const;
+
+	// the member of an object with that key, or nothing
+	std::optional<value> operator[](std::string_view key) const;
+
+	// the index of the value in its tape's words
+	std::size_t position() const { return index; }
+
+private:
+	const tape* t;
+	std::size_t index;
+};
+
+// Goes over the elements of an array or the members of an object. key() is the member's key.
+class tape::value::iterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = tape::value;
+	using difference_type = std::ptrdiff_t;
+	using pointer = void;
+	using reference = tape::value;
+
+	iterator() = default;
+	iterator(const tape& t, const std::size_t index, const bool members) : t{ &t }, index{ index }, members{ members } {}
+
+	tape::value operator*() const { return tape::value{ *t, members ? t->next(index) : index }; }
+
+	std::string_view key() const { return members ? t->text_at(index) : std::string_view{}; }
+
+	iterator& operator++()
+	{
+		index = t->next(members ? t->next(index) : index);
+		return *this;
+	}
+
+	iterator operator++(int)
+	{
+		iterator copy = *this;
+		++*this;
+		return copy;
+	}
+
+	bool operator==(const iterator& other) const { return index == other.index; }
+
+private:
+	const tape* t{};
+	std::size_t index{};
+	bool members{};
+};
+
+inline tape::value tape::root() const { return value{ *this, 0 }; }
+
+inline tape::value::iterator tape::value::begin() const
+{
+	const kind k = type();
+	return k == kind::array || k == kind::object ? iterator{ *t, index + 2, k == kind::object } : end();
+}
+
+inline tape::value::iterator tape::value::end() const
+{
+	const kind k = type();
+	return iterator{ *t, k == kind::array || k == kind::object ? t->next(index) : index, k == kind::object };
+}
+
+inline std::optional<tape::value> tape::value::operator[](std::size_t n) const
+{
+	if (type() != kind::array || n >= size())
+		return std::nullopt;
+
+	iterator it = begin();
+	while (n-- != 0)
+		++it;
+
+	return *it;
+}
+
+inline std::optional<tape::value> tape::value::operator[](const std::string_view key) const
+{
+	if (type() != kind::object)
+		return std::nullopt;
+
+	for (iterator it = begin(); it != end(); ++it)
+	{
+		if (it.key() == key)
+			return *it;
+	}
+
+	return std::nullopt;
+}
+
+} // json
+
+#endif // __JSON_TAPE_HPP
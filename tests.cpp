@@ -1,10 +1,27 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <cmath>
 
 #include "parser.hpp"
 #include "stringifier.hpp"
+#include "async_sink.hpp"
+#include "async_source.hpp"
+#include "compression.hpp"
+#include "parallel_reader.hpp"
+#include "reflection.hpp"
+#include "schema.hpp"
+#include "hash.hpp"
+#include "cache.hpp"
+#include "tracked.hpp"
+#include "tape.hpp"
+#include "patch.hpp"
+#include "compare.hpp"
+#include "allocation_counter.hpp"
 
 using namespace std::string_literals;
 
@@ -49,6 +66,82 @@ bool test(json::parser& parse, const std::string& text, const auto& desc, const
 	return false;
 }
 
+template <typename T>
+bool test_allocations(json::parser& parse, const std::string& text, const auto& desc, const std::size_t budget)
+{
+	T value{};
+	json::allocation_guard guard{};
+	const bool success = parse(text, value, desc);
+	const std::size_t count = guard.count();
+
+	if (success && count <= budget)
+		return true;
+
+	any_failed = true;
+
+	std::cout << "test failed:\n";
+	std::cout << "when parsing: " << std::quoted(text) << '\n';
+	std::cout << "allocations: " << count << " (budget " << budget << ")\n";
+
+	return false;
+}
+
+// writes into fixed storage so that only the stringifier's own allocations are counted
+struct fixed_buffer : std::streambuf
+{
+	char data[256];
+
+	fixed_buffer() { setp(data, data + sizeof(data)); }
+
+	std::string str() const { return std::string(pbase(), pptr()); }
+};
+
+bool test_allocations(json::stringifier& stringify, const auto& obj, const auto& desc, const std::size_t budget)
+{
+	fixed_buffer buffer{};
+	std::ostream os{ &buffer };
+
+	json::allocation_guard guard{};
+	stringify(os, obj, desc);
+	const std::size_t count = guard.count();
+
+	if (count <= budget)
+		return true;
+
+	any_failed = true;
+
+	std::cout << "test failed:\n";
+	std::cout << "when stringifying: " << std::quoted(buffer.str()) << '\n';
+	std::cout << "allocations: " << count << " (budget " << budget << ")\n";
+
+	return false;
+}
+
+// a sink that keeps what it's given, with a tiny buffer so it flushes often
+struct string_sink : json::sink
+{
+	std::string str;
+	char buffer[7];
+
+	string_sink() { set_buffer(buffer, sizeof(buffer)); }
+
+	void flush_buffer() override
+	{
+		str.append(first, pos);
+		pos = first;
+	}
+};
+
+// sinks must produce exactly what a std::ostream would
+bool test_sink(json::stringifier& stringify, const auto& obj, const auto& desc)
+{
+	string_sink sink{};
+	stringify(sink, obj, desc);
+	sink.flush();
+
+	return test(stringify, obj, desc, sink.str);
+}
+
 auto quoted(auto value)
 {
 	std::stringstream ss{};
@@ -83,6 +176,50 @@ constexpr auto PersonDescriptor = std::tuple(
 	json::element(&Person::active, json::boolean)
 );
 
+// records written through a compressing sink must come back through decompressing_source, also
+// when two compressed streams are concatenated, and a cut short stream must be reported
+template <typename Compressor, typename Decompressor>
+bool test_compression(const std::vector<Point>& points, const char* name)
+{
+	json::stringifier stringify{};
+	string_sink compressed{};
+
+	{
+		Compressor sink{ compressed, 1, 16 };
+		for (const Point& point : points)
+		{
+			stringify(sink, point, PointDescriptor);
+			sink.put('\n');
+		}
+	}
+
+	std::istringstream is{ compressed.str + compressed.str };
+	json::parser parse{};
+	json::buffered_reader reader{ json::decompressing_source(std::make_unique<json::istream_source>(is)), 16 };
+	std::vector<Point> parsed;
+
+	const bool parsed_all = parse.for_each<Point>(reader, PointDescriptor, [&](Point&& point) { parsed.push_back(point); });
+
+	std::vector<Point> expectation = points;
+	expectation.insert(expectation.end(), points.begin(), points.end());
+
+	const auto decompression_error = [&](const std::size_t size) {
+		std::istringstream input{ compressed.str.substr(0, size) };
+		Decompressor source{ std::make_unique<json::istream_source>(input) };
+		char buffer[256];
+		while (source.read(buffer, sizeof(buffer)) != 0)
+			;
+		return source.error;
+	};
+
+	if (parsed_all && parsed == expectation && decompression_error(compressed.str.size()) == 0 && decompression_error(compressed.str.size() / 2) != 0)
+		return true;
+
+	any_failed = true;
+	std::cout << "test failed:\nwhen round tripping through " << name << '\n';
+	return false;
+}
+
 int main(int argc, char const *argv[])
 {
 //	std::cout << json::Descriptor<decltype(PointDescriptor)> << '\n';
@@ -189,6 +326,1329 @@ int main(int argc, char const *argv[])
 
 	}
 
+	// updating a value in place ends up the same as parsing a new one, and reuses what's there
+	{
+		struct Settings
+		{
+			std::string name;
+			std::vector<std::string> hosts;
+			std::map<std::string, std::vector<int>> limits;
+			std::optional<Point> origin;
+			Point corners[2];
+			int retries = 3;
+
+			bool operator==(const Settings& other) const
+			{
+				return name == other.name && hosts == other.hosts && limits == other.limits && origin == other.origin
+					&& std::equal(corners, corners + 2, other.corners) && retries == other.retries;
+			}
+		};
+
+		static constexpr auto SettingsDescriptor = std::tuple(
+			json::field("name", &Settings::name, json::string),
+			json::field("hosts", &Settings::hosts, json::array{ json::string }),
+			json::field("limits", &Settings::limits, json::object{ json::array{ json::number } }),
+			json::field("origin", &Settings::origin, PointDescriptor),
+			json::field("corners", &Settings::corners, json::array{ PointDescriptor }),
+			json::field("retries", &Settings::retries, json::number)
+		);
+
+		const std::string messages[] = {
+			"{\"name\":\"first\",\"hosts\":[\"a\",\"b\",\"c\"],\"limits\":{\"x\":[1,2],\"y\":[3]},\"origin\":{\"x\":1,\"y\":2},\"corners\":[{\"x\":1,\"y\":1},{\"x\":2,\"y\":2}],\"retries\":5}",
+			"{\"name\":\"second\",\"hosts\":[\"d\"],\"limits\":{\"y\":[4,5,6],\"z\":[]},\"origin\":null,\"corners\":[{\"x\":3}]}",
+			"{\"hosts\":[\"e\",\"f\"],\"origin\":{\"y\":7}}",
+		};
+
+		json::parser parse{};
+		json::parser update{};
+		update.update = true;
+
+		Settings settings{};
+
+		for (const std::string& message : messages)
+		{
+			Settings expectation{};
+
+			if (!parse(message, expectation, SettingsDescriptor) || !update(message, settings, SettingsDescriptor) || !(settings == expectation))
+			{
+				any_failed = true;
+				std::cout << "test failed:\nwhen updating from: " << std::quoted(message) << '\n';
+			}
+		}
+
+		// the same shape again doesn't allocate
+		update(messages[0], settings, SettingsDescriptor);
+		const char* const host = settings.hosts[0].data();
+
+		json::allocation_guard guard{};
+		const bool success = update(messages[0], settings, SettingsDescriptor);
+		const std::size_t count = guard.count();
+
+		if (!success || count != 0 || settings.hosts[0].data() != host)
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen updating in place, allocations: " << count << '\n';
+		}
+
+		// a bad message leaves the entries it didn't get to
+		std::map<std::string, int> counts{ { "a", 0 }, { "b", 0 }, { "c", 0 } };
+
+		if (update("{\"a\":1,\"b\":x}", counts, json::object{ json::number }) || counts.size() != 3 || counts["a"] != 1 || !counts.contains("c"))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen a map update fails part way\n";
+		}
+
+		// hashed maps keep their buckets too
+		const std::string message = "{\"a\":1,\"b\":2,\"c\":3}";
+		std::unordered_map<std::string, int> hashed;
+		update(message, hashed, json::object{ json::number });
+
+		json::allocation_guard hashed_guard{};
+		const bool hashed_success = update(message, hashed, json::object{ json::number });
+		const std::size_t hashed_count = hashed_guard.count();
+
+		if (!hashed_success || hashed_count != 0 || hashed != std::unordered_map<std::string, int>{ { "a", 1 }, { "b", 2 }, { "c", 3 } }
+			|| !update("{\"b\":4}", hashed, json::object{ json::number }) || hashed != std::unordered_map<std::string, int>{ { "b", 4 } })
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen updating a hashed map in place, allocations: " << hashed_count << '\n';
+		}
+	}
+
+	// merge patches only touch what they mention, json patches what they point at, and diffs make both
+	{
+		struct Endpoint
+		{
+			std::string host;
+			int port;
+			std::optional<int> timeout;
+
+			bool operator==(const Endpoint&) const = default;
+		};
+
+		static constexpr auto EndpointDescriptor = std::tuple(
+			json::field("host", &Endpoint::host, json::string),
+			json::field("port", &Endpoint::port, json::number),
+			json::field("timeout", &Endpoint::timeout, json::number)
+		);
+
+		struct Config
+		{
+			std::string name;
+			Endpoint primary;
+			std::optional<Endpoint> backup;
+			std::vector<Endpoint> mirrors;
+			std::map<std::string, Endpoint> services;
+			int retries = 3;
+
+			bool operator==(const Config&) const = default;
+		};
+
+		static constexpr auto ConfigDescriptor = std::tuple(
+			json::field("name", &Config::name, json::string),
+			json::field("primary", &Config::primary, EndpointDescriptor),
+			json::field("backup", &Config::backup, EndpointDescriptor),
+			json::field("mirrors", &Config::mirrors, json::array{ EndpointDescriptor }),
+			json::field("services", &Config::services, json::object{ EndpointDescriptor }),
+			json::field("retries", &Config::retries, json::number)
+		);
+
+		const Config original{
+			"prod",
+			Endpoint{ "a", 80, 5 },
+			std::nullopt,
+			{ Endpoint{ "m1", 1, {} }, Endpoint{ "m2", 2, 7 } },
+			{ { "auth", Endpoint{ "auth", 443, 10 } }, { "db", Endpoint{ "db", 5432, {} } } },
+			4
+		};
+
+		const auto test_merge_patch = [&](const std::string& patch, const Config& expectation) {
+			Config config = original;
+
+			if (json::merge_patch(patch, config, ConfigDescriptor) && config == expectation)
+				return;
+
+			any_failed = true;
+			std::cout << "test failed:\nwhen merging: " << std::quoted(patch) << '\n';
+		};
+
+		Config expectation = original;
+		test_merge_patch("{}", expectation);
+
+		expectation.name = "staging";
+		expectation.primary.port = 8080;
+		expectation.primary.timeout.reset();
+		test_merge_patch("{\"name\":\"staging\",\"primary\":{\"port\":8080,\"timeout\":null}}", expectation);
+
+		// arrays are replaced, along with their elements' missing members
+		expectation = original;
+		expectation.mirrors = { Endpoint{ "m3", 0, {} } };
+		expectation.backup = Endpoint{ "b", 0, {} };
+		test_merge_patch("{\"mirrors\":[{\"host\":\"m3\"}],\"backup\":{\"host\":\"b\"}}", expectation);
+
+		// maps are merged by key, null erases
+		expectation = original;
+		expectation.services.erase("db");
+		expectation.services["auth"].port = 8443;
+		expectation.services["cache"] = Endpoint{ "cache", 6379, {} };
+		expectation.retries = 3;
+		test_merge_patch("{\"services\":{\"db\":null,\"auth\":{\"port\":8443},\"cache\":{\"host\":\"cache\",\"port\":6379}},\"retries\":null}", expectation);
+
+		Config config = original;
+		if (json::merge_patch("{\"primary\":[]}", config, ConfigDescriptor) || json::merge_patch("{\"unknown\":1}", config, ConfigDescriptor))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen merging a patch that doesn't fit\n";
+		}
+
+		// null resets members without building a new value each time
+		struct Limits
+		{
+			std::vector<int> samples = std::vector<int>(64);
+			int low = 1;
+			int high = 2;
+		};
+
+		static constexpr auto LimitsDescriptor = std::tuple(
+			json::field("samples", &Limits::samples, json::array{ json::number }),
+			json::field("low", &Limits::low, json::number),
+			json::field("high", &Limits::high, json::number)
+		);
+
+		Limits limits{ {}, 5, 6 };
+		json::merge_patch("{\"low\":null}", limits, LimitsDescriptor);
+
+		json::allocation_guard merge_guard{};
+		const bool merged = json::merge_patch("{\"low\":null,\"high\":null}", limits, LimitsDescriptor);
+		const std::size_t merge_count = merge_guard.count();
+
+		if (!merged || merge_count != 0 || limits.low != 1 || limits.high != 2 || !limits.samples.empty())
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen merging nulls, allocations: " << merge_count << '\n';
+		}
+
+		static_assert(json::field_index<json::static_descriptor<ConfigDescriptor>>::find("retries") == 5);
+		static_assert(json::field_index<json::static_descriptor<ConfigDescriptor, 4, 0>>::find("port") == 1);
+		static_assert(json::field_index<json::static_descriptor<ConfigDescriptor>>::find("port") == 6);
+
+		// with the descriptor as a template argument too, where fields are found through sorted tables
+		const auto test_patch = [&](const std::string& patch, const std::optional<Config>& expectation) {
+			Config config = original;
+			Config static_config = original;
+			const bool success = json::apply_patch(patch, config, ConfigDescriptor);
+			const bool static_success = json::apply_patch<ConfigDescriptor>(patch, static_config);
+
+			if (expectation ? success && config == *expectation && static_success && static_config == *expectation : !success && !static_success)
+				return;
+
+			any_failed = true;
+			std::cout << "test failed:\nwhen patching: " << std::quoted(patch) << '\n';
+		};
+
+		expectation = original;
+		expectation.name = "staging";
+		expectation.primary.timeout.reset();
+		expectation.mirrors.insert(expectation.mirrors.begin() + 1, Endpoint{ "m9", 9, {} });
+		expectation.mirrors.push_back(Endpoint{ "m10", 10, {} });
+		expectation.mirrors[0].port = 100;
+		expectation.services.erase("db");
+		expectation.services["a/b~c"] = Endpoint{ "x", 1, {} };
+		expectation.retries = 3;
+
+		test_patch("["
+			"{\"op\":\"test\",\"path\":\"/primary\",\"value\":{\"timeout\":5,\"host\":\"a\",\"port\":80}},"
+			"{\"op\":\"replace\",\"path\":\"/name\",\"value\":\"staging\"},"
+			"{\"path\":\"/primary/timeout\",\"op\":\"remove\"},"
+			"{\"op\":\"add\",\"path\":\"/mirrors/1\",\"value\":{\"host\":\"m9\",\"port\":9}},"
+			"{\"op\":\"add\",\"path\":\"/mirrors/-\",\"value\":{\"host\":\"m10\",\"port\":10}},"
+			"{\"op\":\"replace\",\"path\":\"/mirrors/0/port\",\"value\":100},"
+			"{\"op\":\"remove\",\"path\":\"/services/db\"},"
+			"{\"value\":{\"host\":\"x\",\"port\":1},\"op\":\"add\",\"path\":\"/services/a~1b~0c\"},"
+			"{\"op\":\"test\",\"path\":\"/services/auth/port\",\"value\":443},"
+			"{\"op\":\"remove\",\"path\":\"/retries\"}"
+		"]", expectation);
+
+		expectation = original;
+		expectation.backup = Endpoint{ "b", 2, {} };
+		test_patch("[{\"op\":\"replace\",\"path\":\"\",\"value\":{\"name\":\"prod\",\"primary\":{\"host\":\"a\",\"port\":80,\"timeout\":5},\"mirrors\":[{\"host\":\"m1\",\"port\":1},{\"host\":\"m2\",\"port\":2,\"timeout\":7}],"
+			"\"services\":{\"auth\":{\"host\":\"auth\",\"port\":443,\"timeout\":10},\"db\":{\"host\":\"db\",\"port\":5432}},\"retries\":4}},"
+			"{\"op\":\"add\",\"path\":\"/backup\",\"value\":{\"host\":\"b\",\"port\":2}}]", expectation);
+
+		// paths that don't lead anywhere, failed tests and unknown operations
+		test_patch("[{\"op\":\"test\",\"path\":\"/primary/port\",\"value\":81}]", std::nullopt);
+		test_patch("[{\"op\":\"replace\",\"path\":\"/backup/port\",\"value\":1}]", std::nullopt);
+		test_patch("[{\"op\":\"replace\",\"path\":\"/mirrors/2/port\",\"value\":1}]", std::nullopt);
+		test_patch("[{\"op\":\"replace\",\"path\":\"/mirrors/01/port\",\"value\":1}]", std::nullopt);
+		test_patch("[{\"op\":\"remove\",\"path\":\"/services/cache\"}]", std::nullopt);
+		test_patch("[{\"op\":\"replace\",\"path\":\"/nope\",\"value\":1}]", std::nullopt);
+		test_patch("[{\"op\":\"replace\",\"path\":\"/name/0\",\"value\":1}]", std::nullopt);
+		test_patch("[{\"op\":\"move\",\"from\":\"/name\",\"path\":\"/primary/host\"}]", std::nullopt);
+		test_patch("[{\"op\":\"add\",\"path\":\"/name\"}]", std::nullopt);
+
+		// diffs give back patches that turn one into the other
+		json::stringifier stringify{};
+		stringify.dense = true;
+
+		Config changed = original;
+		changed.name = "staging";
+		changed.primary.timeout.reset();
+		changed.backup = Endpoint{ "b", 2, {} };
+		changed.mirrors.pop_back();
+		changed.mirrors[0].host = "m~/1";
+		changed.services.erase("db");
+		changed.services["auth"].port = 8443;
+		changed.services["a/b"] = Endpoint{ "x", 1, {} };
+
+		const auto test_diff = [&](const Config& from, const Config& to, const std::string& expectation, const std::string& merge_expectation) {
+			const std::string patch = json::diff(from, to, ConfigDescriptor);
+			const std::string merge = json::merge_diff(from, to, ConfigDescriptor);
+
+			Config patched = from;
+			Config merged = from;
+
+			if (patch == expectation && merge == merge_expectation && json::apply_patch(patch, patched, ConfigDescriptor) && json::merge_patch(merge, merged, ConfigDescriptor)
+				&& stringify(patched, ConfigDescriptor) == stringify(to, ConfigDescriptor) && stringify(merged, ConfigDescriptor) == stringify(to, ConfigDescriptor))
+				return;
+
+			any_failed = true;
+			std::cout << "test failed:\nwhen diffing, got: " << patch << "\nand: " << merge << '\n';
+		};
+
+		test_diff(original, original, "[]", "{}");
+
+		// sets lose and gain elements, their elements can't be replaced
+		const auto test_set_diff = [&](const auto& from, const auto& to, const std::string& expectation) {
+			const std::string patch = json::diff(from, to, json::array{ json::number });
+			auto patched = from;
+
+			if (patch == expectation && json::apply_patch(patch, patched, json::array{ json::number }) && patched == to)
+				return;
+
+			any_failed = true;
+			std::cout << "test failed:\nwhen diffing sets, got: " << patch << '\n';
+		};
+
+		test_set_diff(std::set{ 1, 2 }, std::set{ 1, 3 }, "[{\"op\":\"remove\",\"path\":\"\\/1\"},{\"op\":\"add\",\"path\":\"\\/-\",\"value\":3}]");
+		test_set_diff(std::set{ 1, 2, 3, 4 }, std::set{ 2, 4, 5 }, "[{\"op\":\"remove\",\"path\":\"\\/0\"},{\"op\":\"remove\",\"path\":\"\\/1\"},{\"op\":\"add\",\"path\":\"\\/-\",\"value\":5}]");
+		test_set_diff(std::set{ 1, 2 }, std::set{ 1, 2 }, "[]");
+		test_set_diff(std::multiset{ 1, 1, 2 }, std::multiset{ 1, 2 }, "[{\"op\":\"replace\",\"path\":\"\",\"value\":[1,2]}]");
+
+		test_diff(original, changed,
+			"[{\"op\":\"replace\",\"path\":\"\\/name\",\"value\":\"staging\"},"
+			"{\"op\":\"replace\",\"path\":\"\\/primary\\/timeout\",\"value\":null},"
+			"{\"op\":\"replace\",\"path\":\"\\/backup\",\"value\":{\"host\":\"b\",\"port\":2,\"timeout\":null}},"
+			"{\"op\":\"replace\",\"path\":\"\\/mirrors\\/0\\/host\",\"value\":\"m~\\/1\"},"
+			"{\"op\":\"remove\",\"path\":\"\\/mirrors\\/1\"},"
+			"{\"op\":\"replace\",\"path\":\"\\/services\\/auth\\/port\",\"value\":8443},"
+			"{\"op\":\"remove\",\"path\":\"\\/services\\/db\"},"
+			"{\"op\":\"add\",\"path\":\"\\/services\\/a~1b\",\"value\":{\"host\":\"x\",\"port\":1,\"timeout\":null}}]",
+			"{\"name\":\"staging\",\"primary\":{\"timeout\":null},\"backup\":{\"host\":\"b\",\"port\":2,\"timeout\":null},"
+			"\"mirrors\":[{\"host\":\"m~\\/1\",\"port\":1,\"timeout\":null}],\"services\":{\"auth\":{\"port\":8443},\"db\":null,\"a\\/b\":{\"host\":\"x\",\"port\":1,\"timeout\":null}}}");
+
+		test_diff(changed, original,
+			"[{\"op\":\"replace\",\"path\":\"\\/name\",\"value\":\"prod\"},"
+			"{\"op\":\"replace\",\"path\":\"\\/primary\\/timeout\",\"value\":5},"
+			"{\"op\":\"replace\",\"path\":\"\\/backup\",\"value\":null},"
+			"{\"op\":\"replace\",\"path\":\"\\/mirrors\\/0\\/host\",\"value\":\"m1\"},"
+			"{\"op\":\"add\",\"path\":\"\\/mirrors\\/-\",\"value\":{\"host\":\"m2\",\"port\":2,\"timeout\":7}},"
+			"{\"op\":\"remove\",\"path\":\"\\/services\\/a~1b\"},"
+			"{\"op\":\"replace\",\"path\":\"\\/services\\/auth\\/port\",\"value\":443},"
+			"{\"op\":\"add\",\"path\":\"\\/services\\/db\",\"value\":{\"host\":\"db\",\"port\":5432,\"timeout\":null}}]",
+			"{\"name\":\"prod\",\"primary\":{\"timeout\":5},\"backup\":null,"
+			"\"mirrors\":[{\"host\":\"m1\",\"port\":1,\"timeout\":null},{\"host\":\"m2\",\"port\":2,\"timeout\":7}],\"services\":{\"a\\/b\":null,\"auth\":{\"port\":443},\"db\":{\"host\":\"db\",\"port\":5432,\"timeout\":null}}}");
+	}
+
+	// streams
+	{
+		json::parser parse{};
+
+		std::stringstream document{ " { \"x\" : 3, \"y\" : 4 } trailing" };
+		Point point{};
+		if (!parse(document, point, PointDescriptor) || point != Point{3,4})
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing a point from a stream\n";
+		}
+
+		// values are taken one at a time, leaving the rest of the stream in place
+		std::istringstream values{ "1 2\n[3,4]\"five\"{\"x\":6,\"y\":7}true" };
+		int one{}, two{};
+		std::vector<int> three_four;
+		std::string five;
+		Point six_seven{};
+		bool yes{};
+
+		if (!parse(values, one, json::number) || one != 1 ||
+			!parse(values, two, json::number) || two != 2 ||
+			!parse(values, three_four, json::array{ json::number }) || three_four != std::vector<int>{ 3, 4 } ||
+			!parse(values, five, json::string) || five != "five" ||
+			!parse(values, six_seven, PointDescriptor) || six_seven != Point{6,7} || values.eof() ||
+			!parse(values, yes, json::boolean) || !yes || !values.eof() ||
+			parse(values, yes, json::boolean))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing several values from a stream\n";
+		}
+
+#ifdef JSON_HAS_POSIX_IO
+		// a file is rewound past what was read ahead, a pipe is read a byte at a time
+		if (std::FILE* file = std::tmpfile())
+		{
+			std::fputs("[1,2] 3 {\"x\":4,\"y\":5}", file);
+			std::fflush(file);
+			std::rewind(file);
+
+			const int fd = ::fileno(file);
+			std::vector<int> first;
+			int second{};
+			Point third{};
+
+			if (!parse(fd, first, json::array{ json::number }) || first != std::vector<int>{ 1, 2 } ||
+				!parse(fd, second, json::number) || second != 3 ||
+				!parse(fd, third, PointDescriptor) || third != Point{4,5} ||
+				parse(fd, second, json::number))
+			{
+				any_failed = true;
+				std::cout << "test failed:\nwhen parsing several values from a file\n";
+			}
+
+			std::fclose(file);
+		}
+
+		if (int fds[2]; ::pipe(fds) == 0)
+		{
+			const std::string_view text = "[1,2]\"3\" 4\n{\"x\":5,\"y\":6}";
+			const bool written = ::write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size());
+			::close(fds[1]);
+
+			std::vector<int> first;
+			std::string second;
+			int third{};
+			Point fourth{};
+
+			if (!written ||
+				!parse(fds[0], first, json::array{ json::number }) || first != std::vector<int>{ 1, 2 } ||
+				!parse(fds[0], second, json::string) || second != "3" ||
+				!parse(fds[0], third, json::number) || third != 4 ||
+				!parse(fds[0], fourth, PointDescriptor) || fourth != Point{5,6} ||
+				parse(fds[0], third, json::number))
+			{
+				any_failed = true;
+				std::cout << "test failed:\nwhen parsing several values from a pipe\n";
+			}
+
+			::close(fds[0]);
+		}
+#endif
+
+		// a buffer smaller than the records forces both refills and growth
+		std::stringstream records{ "{\"x\":1,\"y\":2}\n{\"x\":-3,\"y\":40000}\n[\"Steve\",25,true]\n\"a \\\" \\\\\"\n123456789 -1.5e3\n" };
+		json::buffered_reader reader{ records, 8 };
+
+		Point a{}, b{};
+		Person person{};
+		std::string text{};
+		long long integer{};
+		double real{};
+
+		if (!parse(reader, a, PointDescriptor) || a != Point{1,2} ||
+			!parse(reader, b, PointDescriptor) || b != Point{-3,40000} ||
+			!parse(reader, person, PersonDescriptor) || person != Person{ "Steve", 25, true } ||
+			!parse(reader, text, json::string) || text != "a \" \\" ||
+			!parse(reader, integer, json::number) || integer != 123456789 ||
+			!parse(reader, real, json::number) || real != -1.5e3 ||
+			parse(reader, real, json::number) || !reader.eof() || reader.failed())
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing records from a stream\n";
+		}
+
+		std::stringstream truncated{ "[1,2,3] [4," };
+		json::buffered_reader truncated_reader{ truncated };
+		std::vector<int> numbers;
+
+		if (!parse(truncated_reader, numbers, json::array{ json::number }) ||
+			parse(truncated_reader, numbers, json::array{ json::number }) || !truncated_reader.failed())
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing a truncated stream\n";
+		}
+	}
+
+	// sinks
+	{
+		json::stringifier stringify{};
+		stringify.pretty = true;
+
+		test_sink(stringify, std::vector<double>{ 0.0, -0.0, 1.23, 4.567, -100.5, 1e20, 0.1 + 0.2, 123456789.0, 1e-7 }, json::array{ json::number }) &&
+		test_sink(stringify, std::vector<long long>{ 0, -1, 281474976710656ll }, json::array{ json::number }) &&
+		test_sink(stringify, std::map<std::string, std::optional<bool>>{ { "a\tb", true }, { "c", {} } }, json::object{ json::boolean }) &&
+		test_sink(stringify, std::vector<Point>{ {3,4}, {5,6} }, json::array{ PointDescriptor }) &&
+		test_sink(stringify, Person{ "Steve \"Stevo\" Stevenson", 25, true }, PersonDescriptor);
+
+#ifdef JSON_HAS_POSIX_IO
+		int fds[2];
+		if (::pipe(fds) == 0)
+		{
+			{
+				json::fd_sink sink{ fds[1], 16 };
+				stringify(sink, std::vector<Point>{ {3,4}, {5,6} }, json::array{ PointDescriptor });
+			}
+
+			::close(fds[1]);
+
+			char buffer[256]{};
+			const ssize_t n = ::read(fds[0], buffer, sizeof(buffer));
+			::close(fds[0]);
+
+			test(stringify, std::vector<Point>{ {3,4}, {5,6} }, json::array{ PointDescriptor }, std::string(buffer, n > 0 ? n : 0));
+		}
+
+		// both background writers, into a file and a pipe, with buffers small enough to be swapped often
+		std::vector<Point> points;
+		for (int i = 0; i < 1000; i++)
+			points.push_back(Point{ i, -i });
+
+		const std::string expectation = stringify(points, json::array{ PointDescriptor });
+
+		for (const bool io_uring : { true, false })
+		{
+			if (std::FILE* file = std::tmpfile())
+			{
+				{
+					json::async_fd_sink sink{ ::fileno(file), 64, io_uring };
+					stringify(sink, points, json::array{ PointDescriptor });
+					sink.finish();
+					std::fseek(file, 0, SEEK_END);
+
+					if (!sink.good() || std::ftell(file) != static_cast<long>(expectation.size()))
+					{
+						any_failed = true;
+						std::cout << "test failed:\nwhen writing through an async_fd_sink, io_uring: " << sink.uses_io_uring() << '\n';
+					}
+				}
+
+				std::string contents(expectation.size(), '\0');
+				std::rewind(file);
+				contents.resize(std::fread(contents.data(), 1, contents.size(), file));
+				std::fclose(file);
+
+				test(stringify, points, json::array{ PointDescriptor }, contents);
+			}
+
+			if (::pipe(fds) == 0)
+			{
+				std::thread writer{ [&]() {
+					json::async_fd_sink sink{ fds[1], 100, io_uring };
+					stringify(sink, points, json::array{ PointDescriptor });
+					sink.finish();
+					::close(fds[1]);
+				} };
+
+				std::string contents;
+				char chunk[4096];
+				for (ssize_t n; (n = ::read(fds[0], chunk, sizeof(chunk))) > 0; )
+					contents.append(chunk, n);
+
+				writer.join();
+				::close(fds[0]);
+
+				test(stringify, points, json::array{ PointDescriptor }, contents);
+			}
+		}
+
+		// and back in through both background readers
+		for (const bool io_uring : { true, false })
+		{
+			std::FILE* file = std::tmpfile();
+			if (file == nullptr)
+				continue;
+
+			{
+				json::fd_sink sink{ ::fileno(file) };
+				for (const Point& point : points)
+				{
+					stringify(sink, point, PointDescriptor);
+					sink.put('\n');
+				}
+			}
+
+			std::rewind(file);
+			::lseek(::fileno(file), 0, SEEK_SET);
+
+			json::parser parse{};
+			json::buffered_reader reader{ std::make_unique<json::async_fd_source>(::fileno(file), 37, io_uring), 16 };
+			std::vector<Point> parsed;
+
+			if (!parse.for_each<Point>(reader, PointDescriptor, [&](Point&& point) { parsed.push_back(point); }) || parsed != points)
+			{
+				any_failed = true;
+				std::cout << "test failed:\nwhen reading through an async_fd_source, io_uring: " << io_uring << '\n';
+			}
+
+			std::fclose(file);
+		}
+#endif
+	}
+
+	// reflection
+	{
+		static_assert(json::member_count_v<decltype(PointDescriptor)> == 2);
+		static_assert(json::is_field_v<std::tuple_element_t<0, std::remove_const_t<decltype(PointDescriptor)>>>);
+		static_assert(json::is_element_v<std::tuple_element_t<0, std::remove_const_t<decltype(PersonDescriptor)>>>);
+		static_assert(std::is_same_v<json::member_value_t<std::tuple_element_t<0, std::remove_const_t<decltype(PersonDescriptor)>>>, std::string>);
+		static_assert(std::is_same_v<json::member_structure_t<std::tuple_element_t<1, std::remove_const_t<decltype(PointDescriptor)>>>, Point>);
+		static_assert(json::for_each_member(PointDescriptor, [](const auto& field) { return field.name[0] != 'y'; }) == false);
+
+		std::string names;
+		json::for_each_member(PointDescriptor, [&](const auto& field) { names += field.name; });
+
+		Point point{ 3, 4 };
+		json::for_each_member(point, PointDescriptor, [](const auto&, int& value) { value *= 10; });
+
+		int visited = 0;
+		const bool stopped = !json::for_each_member(Person{ "Steve", 25, true }, PersonDescriptor, [&](const auto&, const auto& value) {
+			visited++;
+			return !std::is_same_v<std::remove_cvref_t<decltype(value)>, int>;
+		});
+
+		if (names != "xy" || point != Point{ 30, 40 } || !stopped || visited != 2)
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen iterating over descriptors\n";
+		}
+	}
+
+	// values that stringify the same hash the same, and it doesn't change between runs
+	{
+		const auto test_hash = [](const auto& a, const auto& b, const auto& desc, const bool same) {
+			json::stringifier stringify{};
+
+			if ((stringify(a, desc) == stringify(b, desc)) == same && (json::hash(a, desc) == json::hash(b, desc)) == same)
+				return;
+
+			any_failed = true;
+			std::cout << "test failed:\nwhen hashing " << stringify(a, desc) << " and " << stringify(b, desc) << '\n';
+		};
+
+		test_hash(Point{ 3, 4 }, Point{ 3, 4 }, PointDescriptor, true);
+		test_hash(Point{ 3, 4 }, Point{ 4, 3 }, PointDescriptor, false);
+		test_hash(0.1 + 0.2, 0.3, json::number, true);
+		test_hash(0.0, -0.0, json::number, false);
+		test_hash(std::optional<int>{}, std::optional<int>{ 0 }, json::number, false);
+		test_hash(std::vector<std::string>{ "ab", "c" }, std::vector<std::string>{ "a", "bc" }, json::array{ json::string }, false);
+		test_hash(std::vector<std::string>{ "a" }, std::vector<std::string>{ "a", "" }, json::array{ json::string }, false);
+		test_hash(std::map<std::string, bool>{ { "a", true } }, std::map<std::string, bool>{ { "a", false } }, json::object{ json::boolean }, false);
+		test_hash(Person{ "Steve", 25, true }, Person{ "Steve", 25, true }, PersonDescriptor, true);
+		test_hash(std::string(100, 'a'), std::string(99, 'a') + 'b', json::string, false);
+
+		char a[8] = "abc\0xyz", b[8] = "abc\0" "123";
+		test_hash(a, b, json::string, true);
+
+		const auto tape = [](const std::string& text) {
+			json::tape value;
+			json::parser{}(text, value, json::any);
+			return value;
+		};
+
+		test_hash(tape("{ \"a\": [1, \"x\", null], \"b\": {} }"), tape("{\"a\":[1,\"x\",null],\"b\":{}}"), json::any, true);
+		test_hash(tape("{\"a\":[1,\"x\"]}"), tape("{\"a\":[1,\"y\"]}"), json::any, false);
+		test_hash(tape("[1.0]"), tape("[1]"), json::any, false);
+		test_hash(tape("[[],[]]"), tape("[[[]]]"), json::any, false);
+		test_hash(tape("true"), tape("false"), json::any, false);
+		test_hash(std::vector<json::tape>{ tape("{}") }, std::vector<json::tape>{ json::tape{} }, json::array{ json::any }, false);
+
+		if (json::hash(Point{ 3, 4 }, PointDescriptor) != 0x70fd4b4eaee85e94 || json::hash(Point{ 3, 4 }, PointDescriptor, 1) == 0x70fd4b4eaee85e94)
+		{
+			any_failed = true;
+			std::cout << "test failed:\nthe hash of a point changed\n";
+		}
+	}
+
+	// comparing only what's described
+	{
+		const auto test_compare = [](const auto& a, const auto& b, const auto& desc, const std::partial_ordering expectation) {
+			if (json::compare(a, b, desc) == expectation && json::compare(b, a, desc) == (0 <=> expectation) && json::equal(a, b, desc) == (expectation == 0))
+				return;
+
+			json::stringifier stringify{};
+			any_failed = true;
+			std::cout << "test failed:\nwhen comparing " << stringify(a, desc) << " and " << stringify(b, desc) << '\n';
+		};
+
+		test_compare(Point{ 3, 4 }, Point{ 3, 4 }, PointDescriptor, std::partial_ordering::equivalent);
+		test_compare(Point{ 3, 4 }, Point{ 3, 5 }, PointDescriptor, std::partial_ordering::less);
+		test_compare(Point{ 4, 0 }, Point{ 3, 5 }, PointDescriptor, std::partial_ordering::greater);
+		test_compare(Person{ "Steve", 25, true }, Person{ "Steve", 25, false }, PersonDescriptor, std::partial_ordering::greater);
+		test_compare(std::optional<int>{}, std::optional<int>{ -1 }, json::number, std::partial_ordering::less);
+		test_compare(std::optional<int>{}, std::optional<int>{}, json::number, std::partial_ordering::equivalent);
+		test_compare(std::nan(""), 0.0, json::number, std::partial_ordering::unordered);
+		test_compare(std::vector<int>{ 1, 2 }, std::vector<int>{ 1, 2, 0 }, json::array{ json::number }, std::partial_ordering::less);
+		test_compare(std::vector<int>{ 1, 3 }, std::vector<int>{ 1, 2, 0 }, json::array{ json::number }, std::partial_ordering::greater);
+		test_compare(std::vector<Point>{ { 1, 2 } }, std::vector<Point>{ { 1, 2 } }, json::array{ PointDescriptor }, std::partial_ordering::equivalent);
+		test_compare(std::map<std::string, int>{ { "a", 1 } }, std::map<std::string, int>{ { "b", 0 } }, json::object{ json::number }, std::partial_ordering::less);
+		test_compare(std::string("abc"), std::string("abd"), json::string, std::partial_ordering::less);
+
+		char a[8] = "abc\0xyz", b[8] = "abc\0" "123";
+		test_compare(a, b, json::string, std::partial_ordering::equivalent);
+
+		// unordered maps are only ever equal or not, whatever order their entries are in
+		std::unordered_map<std::string, int> c, d;
+		for (int i = 0; i < 100; i++)
+		{
+			c.emplace(std::to_string(i), i);
+			d.emplace(std::to_string(99 - i), 99 - i);
+		}
+
+		test_compare(c, d, json::object{ json::number }, std::partial_ordering::equivalent);
+		d["0"] = 1;
+		test_compare(c, d, json::object{ json::number }, std::partial_ordering::unordered);
+
+		// members that aren't described don't count
+		struct Tagged
+		{
+			int value;
+			int ignored;
+		};
+
+		static constexpr auto TaggedDescriptor = std::tuple(json::field("value", &Tagged::value, json::number));
+		test_compare(Tagged{ 1, 2 }, Tagged{ 1, 3 }, TaggedDescriptor, std::partial_ordering::equivalent);
+	}
+
+	// canonical json, RFC 8785
+	{
+		json::stringifier stringify{};
+		stringify.canonical = true;
+		stringify.pretty = true;
+
+		struct Reversed
+		{
+			int b;
+			std::string a;
+			std::vector<double> c;
+		};
+
+		static constexpr auto ReversedDescriptor = std::tuple(
+			json::field("b", &Reversed::b, json::number),
+			json::field("a", &Reversed::a, json::string),
+			json::field("c", &Reversed::c, json::array{ json::number })
+		);
+
+		test(stringify, Reversed{ 1, "x/y", { 1.5, -0.0 } }, ReversedDescriptor, "{\"a\":\"x/y\",\"b\":1,\"c\":[1.5,0]}");
+
+		// field lists of the same type but with other names don't share an order
+		static constexpr auto SwappedPointDescriptor = std::tuple(
+			json::field("y", &Point::x, json::number),
+			json::field("x", &Point::y, json::number)
+		);
+
+		test(stringify, Point{ 1, 2 }, PointDescriptor, "{\"x\":1,\"y\":2}") &&
+		test(stringify, Point{ 1, 2 }, SwappedPointDescriptor, "{\"x\":2,\"y\":1}") &&
+		test(stringify, Point{ 1, 2 }, PointDescriptor, "{\"x\":1,\"y\":2}");
+
+		// descriptors given as template arguments have their fields sorted at compile time
+		static constexpr auto ReversedListDescriptor = json::array{ ReversedDescriptor };
+		const std::vector<Reversed> reversed{ { 1, "x/y", { 1.5, -0.0 } }, { 2, "", {} } };
+		const std::string static_reversed = stringify.operator()<ReversedListDescriptor>(reversed);
+		if (static_reversed != stringify(reversed, ReversedListDescriptor) || static_reversed != "[{\"a\":\"x/y\",\"b\":1,\"c\":[1.5,0]},{\"a\":\"\",\"b\":2,\"c\":[]}]")
+		{
+			any_failed = true;
+			std::cout << "test failed:\nstatic canonical output was " << static_reversed << "\n";
+		}
+
+		// names that aren't literals are sorted each time, even in a buffer that's reused
+		char first[2] = "a", second[2] = "b";
+		const auto named = std::tuple(json::field(first, &Point::x, json::number), json::field(second, &Point::y, json::number));
+		test(stringify, Point{ 1, 2 }, named, "{\"a\":1,\"b\":2}");
+		first[0] = 'c';
+		test(stringify, Point{ 1, 2 }, named, "{\"b\":2,\"c\":1}");
+
+		test(stringify, std::vector<double>{ 1e21, 1e20, 1e-7, 0.000001, 123.456, -5e-324, 1.7976931348623157e308, 0.1 + 0.2 }, json::array{ json::number },
+			"[1e+21,100000000000000000000,1e-7,0.000001,123.456,-5e-324,1.7976931348623157e+308,0.30000000000000004]");
+		test(stringify, std::vector<float>{ 0.1f, 3.0f }, json::array{ json::number }, "[0.1,3]");
+		test(stringify, std::numeric_limits<double>::infinity(), json::number, "null");
+
+		// integers past 2^53 are written as the double they're read as
+		test(stringify, std::vector<std::int64_t>{ 9007199254740992, 9007199254740993, -9007199254740993, std::numeric_limits<std::int64_t>::min() }, json::array{ json::number },
+			"[9007199254740992,9007199254740992,-9007199254740992,-9223372036854776000]");
+		test(stringify, std::numeric_limits<std::uint64_t>::max(), json::number, "18446744073709552000");
+		test(stringify, std::string("€$\x0f\x7f\"\\\n"), json::string, "\"€$\\u000f\x7f\\\"\\\\\\n\"");
+
+		// keys sort by UTF-16 code units, so U+1F600 comes before U+FB33
+		std::unordered_map<std::string, int> keys{ { "\xef\xac\xb3", 1 }, { "\xf0\x9f\x98\x80", 2 }, { "a", 3 }, { "", 4 }, { "ab", 5 }, { "B", 6 } };
+		test(stringify, keys, json::object{ json::number }, "{\"\":4,\"B\":6,\"a\":3,\"ab\":5,\"\xf0\x9f\x98\x80\":2,\"\xef\xac\xb3\":1}");
+
+		// more keys than fit in place
+		std::unordered_map<std::string, int> many;
+		std::string expectation = "{";
+		for (int i = 0; i < 100; i++)
+		{
+			many.emplace(std::to_string(i + 100), i);
+			expectation += (i == 0 ? "\"" : ",\"") + std::to_string(i + 100) + "\":" + std::to_string(i);
+		}
+		test(stringify, many, json::object{ json::number }, expectation + "}");
+
+		json::parser parse{};
+		json::tape value;
+		parse("{ \"b\": [1.0, 1E2, -0, 2e-7], \"a\": { \"z\": null, \"y\": \"\\/\" } }", value, json::any);
+		test(stringify, value, json::any, "{\"a\":{\"y\":\"/\",\"z\":null},\"b\":[1,100,0,2e-7]}");
+
+		// numbers past the largest double are null like infinities, those below the smallest are 0
+		test(stringify, std::string("1e400"), json::number, "null") &&
+		test(stringify, std::string("-0.00001e-400"), json::number, "0") &&
+		test(stringify, std::string("0.000000000000000000001e330"), json::number, "null") &&
+		test(stringify, std::string_view{ "1e-400" }, json::number, "0");
+		parse("[1e400,2.50,-1E-400]", value, json::any);
+		test(stringify, value, json::any, "[null,2.5,0]");
+
+		// the flags it overrides are left alone
+		if (!stringify.pretty || stringify.dense)
+		{
+			any_failed = true;
+			std::cout << "test failed:\ncanonical output changed the stringifier's other flags\n";
+		}
+	}
+
+	// decimals, held in integers
+	{
+		json::parser parse{};
+		constexpr auto price = json::decimal<8>;
+
+		test<std::int64_t>(parse, "12.34", price, 1'234'000'000) &&
+		test<std::int64_t>(parse, "-0.00000001", price, -1) &&
+		test<std::int64_t>(parse, "0", price, 0) &&
+		test<std::int64_t>(parse, "-0.0", price, 0) &&
+		test<std::int64_t>(parse, "1.50000000000000000000000", price, 150'000'000) &&
+		test<std::int64_t>(parse, "1234e-8", price, 1234) &&
+		test<std::int64_t>(parse, "0.000000012E1", price, 12) &&
+		test<std::int64_t>(parse, "92233720368.54775807", price, std::numeric_limits<std::int64_t>::max()) &&
+		test<std::int64_t>(parse, "-92233720368.54775808", price, std::numeric_limits<std::int64_t>::min()) &&
+		test<std::int32_t>(parse, "-21474836.48", json::decimal<2>, std::numeric_limits<std::int32_t>::min()) &&
+		test<std::uint64_t>(parse, "18446744073709551615", json::decimal<0>, std::numeric_limits<std::uint64_t>::max()) &&
+		test<std::int64_t>(parse, "2.5", json::decimal<0, json::rounding::half_even>, 2) &&
+		test<std::int64_t>(parse, "3.5", json::decimal<0, json::rounding::half_even>, 4) &&
+		test<std::int64_t>(parse, "-2.51", json::decimal<0, json::rounding::half_even>, -3) &&
+		test<std::int64_t>(parse, "0.1250000000000000000001", json::decimal<2, json::rounding::half_even>, 13) &&
+		test<std::int64_t>(parse, "1e-40", json::decimal<2, json::rounding::half_even>, 0) &&
+		test<std::int64_t>(parse, "-2.99", json::decimal<0, json::rounding::truncate>, -2) &&
+		test<std::optional<std::int64_t>>(parse, "null", price, std::nullopt);
+
+		// too precise for exact decimals, too large, or not a number
+		for (const char* text : { "0.000000001", "92233720368.54775808", "1e30", "123456789012345678901234", "1.", "-", ".5", "1e", "\"1\"" })
+		{
+			std::int64_t value = 7;
+			if (parse(text, value, price) || value != 7)
+			{
+				any_failed = true;
+				std::cout << "test failed:\nwhen parsing " << std::quoted(text) << " as a decimal\n";
+			}
+		}
+
+		std::uint32_t unsigned_value{};
+		if (parse("-1", unsigned_value, json::decimal<0>))
+		{
+			any_failed = true;
+			std::cout << "test failed:\na negative decimal was parsed into an unsigned integer\n";
+		}
+
+		json::stringifier stringify{};
+		stringify.dense = true;
+
+		test(stringify, std::vector<std::int64_t>{ 1'234'000'000, -1, 0, 100'000'000, std::numeric_limits<std::int64_t>::min() }, json::array{ price },
+			"[12.34,-0.00000001,0,1,-92233720368.54775808]") &&
+		test(stringify, std::int32_t{ 1200 }, json::decimal<0>, "1200");
+
+		stringify.canonical = true;
+		test(stringify, std::vector<std::int64_t>{ 1'234'000'000, -1, 100 }, json::array{ price }, "[12.34,-1e-8,0.000001]");
+
+		// more digits than a double holds are written as the double nearest, like any other number
+		test(stringify, std::vector<std::int64_t>{ 1'234'567'890'123'456, std::numeric_limits<std::int64_t>::min() }, json::array{ json::decimal<2> },
+			"[12345678901234.56,-92233720368547760]");
+
+		if (json::schema<std::int64_t>(price) != "{\"$schema\":\"https://json-schema.org/draft/2020-12/schema\",\"type\":\"number\",\"multipleOf\":0.00000001}" ||
+			json::compare(std::int64_t{ 1 }, std::int64_t{ 2 }, price) >= 0 || json::hash(std::int64_t{ 1 }, price) != json::hash(std::int64_t{ 1 }, price))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen describing, comparing or hashing decimals\n";
+		}
+	}
+
+	// numbers kept as they're written
+	{
+		json::parser parse{};
+
+		test<std::string>(parse, "123456789012345678901234567890", json::number, "123456789012345678901234567890") &&
+		test<std::string>(parse, "-0.1000000000000000000000000001e-400", json::number, "-0.1000000000000000000000000001e-400") &&
+		test<std::vector<std::string>>(parse, "[1, 2.50 ,3E+2]", json::array{ json::number }, std::vector<std::string>{ "1", "2.50", "3E+2" }) &&
+		test<std::optional<std::string>>(parse, "null", json::number, std::nullopt);
+
+		struct Id
+		{
+			char value[8];
+
+			bool operator==(const Id& other) const { return std::string_view{ value } == other.value; }
+		};
+
+		static constexpr auto IdDescriptor = std::tuple(json::element(&Id::value, json::number));
+		test<Id>(parse, "[1234567]", IdDescriptor, Id{ "1234567" });
+
+		// numbers that aren't json, or that don't fit
+		for (const char* text : { "[01]", "[-]", "[1.]", "[.5]", "[1e+]", "[\"1\"]", "[12345678]" })
+		{
+			Id value{};
+			if (parse(text, value, IdDescriptor))
+			{
+				any_failed = true;
+				std::cout << "test failed:\nwhen parsing " << std::quoted(text) << " as a number kept as text\n";
+			}
+		}
+
+		// views point into the text
+		const std::string text = "[18446744073709551616]";
+		std::vector<std::string_view> views;
+		if (!parse(text, views, json::array{ json::number }) || views.size() != 1 || views[0].data() != text.data() + 1 || views[0] != "18446744073709551616")
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing a number into a view\n";
+		}
+
+		// but only into text the caller holds, streams reuse their buffers
+		struct Quote
+		{
+			std::optional<std::string_view> price;
+		};
+
+		static constexpr auto QuoteDescriptor = std::tuple(json::field("price", &Quote::price, json::number));
+
+		static_assert(!json::SelfContained<std::vector<std::string_view>, json::array<json::number_t>>);
+		static_assert(!json::SelfContained<std::map<std::string, Quote>, json::object<decltype(QuoteDescriptor)>>);
+		static_assert(json::SelfContained<std::vector<std::string>, json::array<json::number_t>>);
+		static_assert(json::SelfContained<std::string_view, json::string_t> && json::SelfContained<Id, decltype(IdDescriptor)>);
+
+		json::stringifier stringify{};
+		stringify.dense = true;
+
+		test(stringify, std::vector<std::string>{ "1.50", "123456789012345678901234567890" }, json::array{ json::number }, "[1.50,123456789012345678901234567890]") &&
+		test(stringify, Id{ "-1e5" }, IdDescriptor, "[-1e5]");
+
+		// text that isn't a number is written as null, rather than made up or written as it is
+		test(stringify, std::vector<std::string>{ "", "1,\"admin\":true", "01", "1e", " 1", "NaN" }, json::array{ json::number }, "[null,null,null,null,null,null]") &&
+		test(stringify, Id{ "1 " }, IdDescriptor, "[null]");
+
+		stringify.canonical = true;
+		test(stringify, std::vector<std::string>{ "1.50", "-1E5" }, json::array{ json::number }, "[1.5,-100000]");
+
+		if (json::hash("1.0"s, json::number) != json::hash(Id{ "1.0" }.value, json::number) || !json::equal("1.0"s, "1.0"s, json::number) ||
+			json::compare("1.0"s, "1"s, json::number) != std::partial_ordering::unordered)
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen comparing or hashing numbers kept as text\n";
+		}
+	}
+
+	// unordered maps in key order
+	{
+		json::stringifier stringify{};
+		stringify.sorted = true;
+
+		std::unordered_map<std::string, int> small{ { "c", 3 }, { "a", 1 }, { "b", 2 } };
+		test(stringify, small, json::object{ json::number }, "{ \"a\": 1, \"b\": 2, \"c\": 3 }");
+
+		std::map<std::string, int, std::greater<>> reversed{ { "a", 1 }, { "b", 2 } };
+		test(stringify, reversed, json::object{ json::number }, "{ \"a\": 1, \"b\": 2 }");
+
+		stringify.pretty = true;
+		std::unordered_map<std::string, std::vector<int>> nested{ { "y", { 2 } }, { "x", { 1 } } };
+		test(stringify, nested, json::object{ json::array{ json::number } }, "{\n\t\"x\": [ 1 ],\n\t\"y\": [ 2 ]\n}");
+
+		std::unordered_map<std::string, int> many;
+		std::string expectation = "{ ";
+		for (int i = 0; i < 100; i++)
+		{
+			many.emplace("k" + std::to_string(i + 100), i);
+			expectation += (i == 0 ? "\"k" : ", \"k") + std::to_string(i + 100) + "\": " + std::to_string(i);
+		}
+		test(stringify, many, json::object{ json::number }, expectation + " }");
+
+		// small maps are sorted in place
+		test_allocations(stringify, small, json::object{ json::number }, 0);
+	}
+
+	// cached stringified values, one per format, only redone after a change
+	{
+		json::cached points{ std::vector<Point>{ {1,2}, {3,4} }, json::array{ PointDescriptor } };
+
+		json::stringifier stringify{};
+		json::stringifier pretty{};
+		pretty.pretty = true;
+
+		const auto text = points.str();
+		const std::uint64_t version = points.version();
+
+		std::size_t allocations;
+		{
+			json::allocation_guard guard{};
+			points.str();
+			allocations = guard.count();
+		}
+
+		const bool formats_kept_apart = *points.str(pretty) == pretty(*points, json::array{ PointDescriptor }) && *points.str() == *text;
+
+		points.modify().push_back(Point{ 5, 6 });
+
+		std::ostringstream os;
+		points.write(os);
+
+		string_sink sink{};
+		points.write(sink, pretty);
+		sink.flush();
+
+		if (allocations != 0 || !formats_kept_apart || *text != stringify(std::vector<Point>{ {1,2}, {3,4} }, json::array{ PointDescriptor }) ||
+			points.version() == version || os.str() != stringify(*points, json::array{ PointDescriptor }) || sink.str != pretty(*points, json::array{ PointDescriptor }))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen caching stringified values\n";
+		}
+	}
+
+	// tracked values only stringify the fields that changed, and look no different for it
+	{
+		struct State
+		{
+			int tick;
+			std::vector<Point> points;
+			std::map<std::string, Person> people;
+		};
+
+		static constexpr auto StateDescriptor = std::tuple(
+			json::field("tick", &State::tick, json::number),
+			json::field("points", &State::points, json::array{ PointDescriptor }),
+			json::field("people", &State::people, json::object{ PersonDescriptor })
+		);
+
+		struct Document
+		{
+			std::string name;
+			json::tracked<State, decltype(StateDescriptor)> state;
+		};
+
+		struct PlainDocument
+		{
+			std::string name;
+			State state;
+		};
+
+		static constexpr auto DocumentDescriptor = std::tuple(
+			json::field("name", &Document::name, json::string),
+			json::field("state", &Document::state, StateDescriptor)
+		);
+
+		static constexpr auto PlainDocumentDescriptor = std::tuple(
+			json::field("name", &PlainDocument::name, json::string),
+			json::field("state", &PlainDocument::state, StateDescriptor)
+		);
+
+		Document document{ "doc", { State{ 1, { {1,2}, {3,4} }, { { "steve", Person{ "Steve", 25, true } } } }, StateDescriptor } };
+
+		// every format, at the top and nested
+		for (const bool dense : { false, true })
+		{
+			for (const bool pretty : { false, true })
+			{
+				json::stringifier stringify{};
+				stringify.dense = dense;
+				stringify.pretty = pretty;
+
+				document.state.modify(&State::tick)++;
+				test(stringify, document.state, StateDescriptor, stringify(*document.state, StateDescriptor));
+				test(stringify, document, DocumentDescriptor, stringify(PlainDocument{ document.name, *document.state }, PlainDocumentDescriptor));
+			}
+		}
+
+		// unchanged fields are spliced in without looking at the value again
+		json::stringifier stringify{};
+		int& tick = document.state.modify(&State::tick);
+		stringify(document.state, StateDescriptor);
+
+		tick = 100;
+		document.state.modify(&State::points).push_back(Point{ 5, 6 });
+
+		const std::bitset<3> changed = document.state.changed();
+		const std::string spliced = stringify(document.state, StateDescriptor);
+
+		State stale = *document.state;
+		stale.tick = 5;
+
+		document.state.modify();
+
+		if (changed != std::bitset<3>{ 0b010 } || spliced != stringify(stale, StateDescriptor) || stringify(document.state, StateDescriptor) != stringify(*document.state, StateDescriptor))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen stringifying only the changed fields\n";
+		}
+	}
+
+	// schemaless values on a tape
+	{
+		struct Message
+		{
+			int id;
+			json::tape metadata;
+		};
+
+		static constexpr auto MessageDescriptor = std::tuple(
+			json::field("id", &Message::id, json::number),
+			json::field("metadata", &Message::metadata, json::any)
+		);
+
+		json::parser parse{};
+		Message message{};
+		const std::string text = "{\"id\":7,\"metadata\":{\"tags\":[\"a\",\"b\\n\",null,true],\"nested\":{\"n\":1.50e3,\"list\":[[],{}]},\"x\":-0.25}}";
+
+		if (!parse(text, message, MessageDescriptor))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing: " << std::quoted(text) << '\n';
+		}
+
+		const json::tape::value metadata = message.metadata.root();
+		const auto tags = metadata["tags"];
+		const auto nested = metadata["nested"];
+
+		if (metadata.type() != json::tape::kind::object || metadata.size() != 3 || !tags || tags->size() != 4
+			|| (*tags)[1]->as_string() != "b\n" || !(*tags)[2]->is_null() || !(*tags)[3]->as_bool() || (*tags)[4]
+			|| !nested || (*nested)["n"]->as_string() != "1.50e3" || (*nested)["n"]->as_number<double>() != 1500.0
+			|| (*nested)["n"]->as_number<int>() || (*nested)["list"]->size() != 2 || metadata["missing"]
+			|| metadata["x"]->as_number<double>() != -0.25 || std::distance(metadata.begin(), metadata.end()) != 3
+			|| metadata.begin().key() != "tags")
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen navigating a tape\n";
+		}
+
+		// numbers come back as they were written
+		json::stringifier stringify{};
+		stringify.dense = true;
+		test(stringify, message, MessageDescriptor, text);
+
+		stringify.dense = false;
+		test(stringify, message, MessageDescriptor, "{ \"id\": 7, \"metadata\": { \"tags\": [ \"a\", \"b\\n\", null, true ], \"nested\": { \"n\": 1.50e3, \"list\": [[], {}] }, \"x\": -0.25 } }");
+
+		// and it looks like the typed value would
+		stringify.pretty = true;
+		json::tape point;
+		parse("{\"x\":3,\"y\":4}", point, json::any);
+		test(stringify, point, json::any, stringify(Point{3,4}, PointDescriptor));
+
+		std::vector<json::tape> values;
+		if (!parse("[1, \"two\", [3], {\"four\": 4}, null]", values, json::array{ json::any }) || values.size() != 5 || !values[4].root().is_null()
+			|| parse("{\"a\":tru}", point, json::any) || parse("[1,", point, json::any) || parse("nul", point, json::any))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing any values\n";
+		}
+
+		test(stringify, json::tape{}, json::any, "null");
+
+		// a failed parse leaves nothing half written behind
+		if (parse("[1, [2, 3", point, json::any) || !point.empty() ||
+			parse("{\"id\":8,\"metadata\":{\"tags\":[\"a\",{\"b\":", message, MessageDescriptor) || !message.metadata.empty())
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen parsing an unfinished value onto a tape\n";
+		}
+
+		test(stringify, point, json::any, "null");
+		test(stringify, message.metadata, json::any, "null");
+
+		// updating, merging and patching replace the tape's strings, rather than clearing them one by one
+		stringify.pretty = false;
+		stringify.dense = true;
+
+		json::parser update{};
+		update.update = true;
+
+		Message updated{};
+		update("{\"id\":1,\"metadata\":{\"abc\":\"hello\",\"k\":[\"x\",\"yy\"]}}", updated, MessageDescriptor);
+		test(stringify, updated.metadata, json::any, "{\"abc\":\"hello\",\"k\":[\"x\",\"yy\"]}");
+
+		json::merge_patch("{\"metadata\":{\"first\":\"one\",\"second\":[\"two\",\"three\"]}}", updated, MessageDescriptor);
+		test(stringify, updated.metadata, json::any, "{\"first\":\"one\",\"second\":[\"two\",\"three\"]}");
+
+		if (!json::apply_patch("[{\"op\":\"replace\",\"path\":\"/metadata\",\"value\":{\"a\":\"xyz\",\"b\":\"y\"}}]", updated, MessageDescriptor))
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen patching a tape\n";
+		}
+
+		test(stringify, updated.metadata, json::any, "{\"a\":\"xyz\",\"b\":\"y\"}");
+	}
+
+	// json schema
+	{
+		const auto test_schema = [](const std::string_view result, const std::string_view expectation) {
+			if (result == expectation)
+				return;
+
+			any_failed = true;
+			std::cout << "test failed:\n";
+			std::cout << "expectation: " << expectation << '\n';
+			std::cout << "got: " << result << '\n';
+		};
+
+		constexpr std::string_view schema_prefix = "{\"$schema\":\"https://json-schema.org/draft/2020-12/schema\",";
+		constexpr std::string_view int_schema = "{\"type\":\"integer\",\"minimum\":-2147483648,\"maximum\":2147483647}";
+
+		test_schema(json::schema_v<Point, PointDescriptor>,
+			std::string(schema_prefix) + "\"type\":\"object\",\"properties\":{\"x\":" + std::string(int_schema) + ",\"y\":" + std::string(int_schema) + "},\"required\":[\"x\",\"y\"],\"additionalProperties\":false}");
+
+		test_schema(json::schema<Person>(PersonDescriptor),
+			std::string(schema_prefix) + "\"type\":\"array\",\"prefixItems\":[{\"type\":\"string\"}," + std::string(int_schema) + ",{\"type\":\"boolean\"}],\"items\":false,\"minItems\":3}");
+
+		test_schema(json::schema<std::map<std::string, std::optional<double>>>(json::object{ json::number }),
+			std::string(schema_prefix) + "\"type\":\"object\",\"additionalProperties\":{\"anyOf\":[{\"type\":\"number\"},{\"type\":\"null\"}]}}");
+
+		test_schema(json::schema<std::array<char[8], 2>>(json::array{ json::string }),
+			std::string(schema_prefix) + "\"type\":\"array\",\"items\":{\"type\":\"string\",\"maxLength\":7},\"maxItems\":2}");
+
+		test_schema(json::schema<std::vector<unsigned long long>>(json::array{ json::number }),
+			std::string(schema_prefix) + "\"type\":\"array\",\"items\":{\"type\":\"integer\",\"minimum\":0}}");
+
+		test_schema(json::schema<std::vector<json::tape>>(json::array{ json::any }),
+			std::string(schema_prefix) + "\"type\":\"array\",\"items\":{}}");
+
+		test_schema(json::schema<json::tape>(json::any), "{\"$schema\":\"https://json-schema.org/draft/2020-12/schema\"}");
+	}
+
+	// compressed streams
+	{
+		std::vector<Point> points;
+		for (int i = 0; i < 1000; i++)
+			points.push_back(Point{ i, i * i });
+
+#ifdef JSON_WITH_ZLIB
+		test_compression<json::gzip_sink, json::gzip_source>(points, "gzip");
+#endif
+#ifdef JSON_WITH_ZSTD
+		test_compression<json::zstd_sink, json::zstd_source>(points, "zstd");
+
+		// small frames holding whole records, parsed on a few threads and handed over in order
+		string_sink compressed{};
+		{
+			json::stringifier stringify{};
+			json::zstd_sink sink{ compressed, 1, 64 };
+
+			for (const Point& point : points)
+			{
+				stringify(sink, point, PointDescriptor);
+				sink.put('\n');
+
+				if (sink.frame_size() > 500)
+					sink.end_frame();
+			}
+		}
+
+		for (const std::size_t size : { compressed.str.size(), compressed.str.size() - 1 })
+		{
+			std::istringstream is{ compressed.str.substr(0, size) };
+			std::vector<Point> parsed;
+
+			const bool success = json::parallel_for_each<Point>(std::make_unique<json::istream_source>(is), PointDescriptor, [&](Point&& point) { parsed.push_back(point); }, 3);
+
+			// a cut short input hands over the frames before it
+			if (size == compressed.str.size() ? !success || parsed != points : success || parsed.empty() || !std::equal(parsed.begin(), parsed.end(), points.begin()))
+			{
+				any_failed = true;
+				std::cout << "test failed:\nwhen reading zstd frames in parallel, " << size << " bytes\n";
+			}
+		}
+
+		// a source reset after a failure reads the next stream from the start
+		json::zstd_source source{ std::make_unique<json::memory_source>(std::string_view{ compressed.str }.substr(0, 10)) };
+		char discarded[64];
+		while (source.read(discarded, sizeof(discarded)) != 0) {}
+		const bool failed_before = source.failed();
+		source.reset(std::make_unique<json::memory_source>(compressed.str));
+		std::string decompressed(64, '\0');
+		decompressed.resize(source.read(decompressed.data(), decompressed.size()));
+
+		if (!failed_before || !decompressed.starts_with("{ \"x\": 0") || source.failed())
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen reading zstd after a reset, got " << decompressed << "\n";
+		}
+#endif
+
+		// anything else passes through untouched
+		std::istringstream is{ "{\"x\":1,\"y\":2} {\"x\":3,\"y\":4}" };
+		json::parser parse{};
+		json::buffered_reader reader{ json::decompressing_source(std::make_unique<json::istream_source>(is)), 16 };
+		std::vector<Point> parsed;
+
+		if (!parse.for_each<Point>(reader, PointDescriptor, [&](Point&& point) { parsed.push_back(point); }) || parsed != std::vector<Point>{ {1,2}, {3,4} })
+		{
+			any_failed = true;
+			std::cout << "test failed:\nwhen reading uncompressed input through decompressing_source\n";
+		}
+	}
+
+	// every kernel the cpu supports must agree with the scalar one
+	for (const json::simd::isa isa : { json::simd::isa::scalar, json::simd::isa::sse2, json::simd::isa::avx2, json::simd::isa::avx512 })
+	{
+		if (!json::simd::force(isa))
+			continue;
+
+		json::stringifier stringify{};
+		json::parser parse{};
+
+		for (std::size_t i = 0; i < 130; i++)
+		{
+			const std::string plain(i, 'a');
+			const std::string text = plain + "\"/\\\t" + plain;
+			const std::string escaped = plain + "\\\"\\/\\\\\\t" + plain;
+
+			test(stringify, text, json::string, '"' + escaped + '"') &&
+			test(parse, '"' + escaped + '"', json::string, text) &&
+			test(parse, '"' + plain + '"', json::string, plain);
+
+			for (const char c : { '"', '[', ']', '{', '}' })
+			{
+				const std::string structural = plain + "\\:;,<>|" + c + plain;
+				if (json::simd::find_structural(structural.data(), structural.data() + structural.size()) != structural.data() + i + 7)
+				{
+					any_failed = true;
+					std::cout << "test failed:\nfind_structural with " << json::simd::name(isa) << " kernels\n";
+				}
+			}
+		}
+	}
+
+	json::simd::force(json::simd::best_supported());
+
+	// allocation budgets
+	{
+		json::parser parse{};
+
+		test_allocations<bool>(parse, "true", json::boolean, 0) &&
+		test_allocations<double>(parse, "-100.5e3", json::number, 0) &&
+		test_allocations<std::optional<int>>(parse, "null", json::number, 0) &&
+		test_allocations<std::string>(parse, "\"hello\"", json::string, 0) &&
+		test_allocations<Point>(parse, "{\"x\":3,\"y\":4}", PointDescriptor, 0) &&
+		test_allocations<Point>(parse, "{ \"x\" : 3 , \"y\" : 4 }", PointDescriptor, 0) &&
+		test_allocations<Person>(parse, "[\"Steve\",25,true]", PersonDescriptor, 0) &&
+		test_allocations<std::vector<int>>(parse, "[4,5,6]", json::array{ json::number }, 3);
+
+		json::stringifier stringify{};
+
+		test_allocations(stringify, Point{3,4}, PointDescriptor, 0) &&
+		test_allocations(stringify, Person{ "Steve", 25, true }, PersonDescriptor, 0) &&
+		test_allocations(stringify, std::vector<int>{4,5,6}, json::array{ json::number }, 0);
+	}
+
 	if (!any_failed)
 		std::cout << "all good.";
+
+	return any_failed ? 1 : 0;
 }
\ No newline at end of file
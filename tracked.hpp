@@ -0,0 +1,86 @@
+#ifndef __JSON_TRACKED_HPP
+#define __JSON_TRACKED_HPP
+
+#include <bitset>
+#include <string>
+#include <tuple>
+#include <cstdint>
+
+#include "json.hpp"
+#include "reflection.hpp"
+#include "stringifier.hpp"
+
+namespace json
+{
+
+// Wraps a value described by a field list and remembers which fields changed since it was last
+// stringified. The stringifier keeps each field's stringified value and only redoes the changed
+// ones, splicing the rest in as they were, so a large document that changes a few fields at a time
+// costs little more than those fields to write out again. It can be a member of another described
+// type, described by the same field list.
+//
+// Changes go through modify(member), or modify() for the whole value, before they're made. Writing
+// through the returned reference later goes unnoticed. Not safe to stringify from several threads
+// at once.
+template <typename T, typename TFields> requires (is_field_list_v<TFields> && member_count_v<TFields> != 0)
+class tracked_value
+{
+public:
+	static constexpr std::size_t field_count = member_count_v<TFields>;
+
+	tracked_value(T value, const TFields& fields) : current{ std::move(value) }, fields{ fields } {}
+
+	const T& value() const { return current; }
+	const T& operator*() const { return current; }
+	const T* operator->() const { return &current; }
+
+	// marks every field changed
+	T& modify()
+	{
+		cache.dirty.set();
+		return current;
+	}
+
+	// marks the field of that member changed
+	template <typename TValue>
+	TValue& modify(TValue T::* const member)
+	{
+		std::size_t index{};
+
+		for_each_member(fields, [&](const auto& field) {
+			if constexpr (std::is_same_v<member_value_t<decltype(field)>, TValue>)
+			{
+				if (field.member_ptr == member)
+					cache.dirty.set(index);
+			}
+
+			index++;
+		});
+
+		return current.*member;
+	}
+
+	// the fields that will be stringified again
+	const std::bitset<field_count>& changed() const { return cache.dirty; }
+
+private:
+	friend struct stringifier;
+
+	T current;
+	TFields fields;
+
+	mutable struct
+	{
+		std::string values[field_count];
+		std::bitset<field_count> dirty{ std::bitset<field_count>{}.set() };
+		std::int64_t format{ -1 }; // the formatting the values were stringified with
+	} cache;
+};
+
+// the descriptor's type can be given as decltype of a constexpr descriptor
+template <typename T, typename TFields>
+using tracked = tracked_value<T, std::remove_const_t<TFields>>;
+
+} // json
+
+#endif // __JSON_TRACKED_HPP